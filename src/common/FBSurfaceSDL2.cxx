@@ -24,6 +24,8 @@ FBSurfaceSDL2::FBSurfaceSDL2(FrameBufferSDL2& buffer,
     mySurface(nullptr),
     myTexture(nullptr),
     mySurfaceIsDirty(true),
+    myAllRowsDirty(true),
+    myDirectAccess(false),
     myIsVisible(true),
     myTexAccess(SDL_TEXTUREACCESS_STREAMING),
     myInterpolate(false),
@@ -61,6 +63,61 @@ void FBSurfaceSDL2::fillRect(uInt32 x, uInt32 y, uInt32 w, uInt32 h, uInt32 colo
   SDL_FillRect(mySurface, &tmp, myPalette[color]);
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void FBSurfaceSDL2::setDirtyRows(uInt32 y, uInt32 h)
+{
+  mySurfaceIsDirty = true;
+  if(h == 0)
+    return;
+
+  // Going back to updating through the SDL_Surface
+  myDirectAccess = false;
+  if(myAllRowsDirty)
+    return;
+
+  // Extend the last band when possible; with too many bands (ie, when the
+  // surface isn't rendered for a while), just update everything
+  if(!myDirtyRows.empty() &&
+     myDirtyRows.back().first + myDirtyRows.back().second == y)
+    myDirtyRows.back().second += h;
+  else if(myDirtyRows.size() < 32)
+    myDirtyRows.emplace_back(y, h);
+  else
+    myAllRowsDirty = true;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool FBSurfaceSDL2::lockRows(uInt32 y, uInt32 h, uInt32*& pixels, uInt32& pitch)
+{
+  // A texture which was just (re)created must first be filled completely
+  // from the SDL_Surface
+  if(myTexAccess != SDL_TEXTUREACCESS_STREAMING || !myTexture || myAllRowsDirty)
+    return false;
+
+  SDL_Rect r;
+  r.x = 0;  r.y = y;
+  r.w = mySurface->w;  r.h = h;
+
+  void* texPixels;
+  int texPitch;
+  if(SDL_LockTexture(myTexture, &r, &texPixels, &texPitch) != 0)
+    return false;
+
+  pixels = static_cast<uInt32*>(texPixels);
+  pitch  = texPitch / sizeof(uInt32);
+
+  mySurfaceIsDirty = myDirectAccess = true;
+  myAllRowsDirty = false;
+  myDirtyRows.clear();
+  return true;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void FBSurfaceSDL2::unlockRows()
+{
+  SDL_UnlockTexture(myTexture);
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 uInt32 FBSurfaceSDL2::width() const
 {
@@ -90,6 +147,7 @@ void FBSurfaceSDL2::setSrcPos(uInt32 x, uInt32 y)
 {
   mySrcR.x = x;  mySrcR.y = y;
   mySrcGUIR.moveTo(x, y);
+  myAllRowsDirty = true;
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -97,6 +155,7 @@ void FBSurfaceSDL2::setSrcSize(uInt32 w, uInt32 h)
 {
   mySrcR.w = w;  mySrcR.h = h;
   mySrcGUIR.setWidth(w);  mySrcGUIR.setHeight(h);
+  myAllRowsDirty = true;
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -135,11 +194,34 @@ bool FBSurfaceSDL2::render()
 //cerr << "dst: x=" << myDstR.x << ", y=" << myDstR.y << ", w=" << myDstR.w << ", h=" << myDstR.h << endl;
 
 //cerr << "render()\n";
-    if(myTexAccess == SDL_TEXTUREACCESS_STREAMING)
-      SDL_UpdateTexture(myTexture, &mySrcR, mySurface->pixels, mySurface->pitch);
+    if(myTexAccess == SDL_TEXTUREACCESS_STREAMING && !myDirectAccess)
+    {
+      if(myAllRowsDirty)
+        SDL_UpdateTexture(myTexture, &mySrcR, mySurface->pixels, mySurface->pitch);
+      else
+      {
+        // Only upload the rows that changed, clipped to the source rectangle
+        for(const auto& rows: myDirtyRows)
+        {
+          const int top = std::max(int(rows.first), mySrcR.y);
+          const int bottom = std::min(int(rows.first + rows.second),
+                                      mySrcR.y + mySrcR.h);
+          if(top >= bottom)
+            continue;
+
+          SDL_Rect r;
+          r.x = mySrcR.x;  r.y = top;
+          r.w = mySrcR.w;  r.h = bottom - top;
+          const uInt8* pixels = static_cast<const uInt8*>(mySurface->pixels) +
+              top * mySurface->pitch + r.x * mySurface->format->BytesPerPixel;
+          SDL_UpdateTexture(myTexture, &r, pixels, mySurface->pitch);
+        }
+      }
+    }
     SDL_RenderCopy(myFB.myRenderer, myTexture, &mySrcR, &myDstR);
 
-    mySurfaceIsDirty = false;
+    mySurfaceIsDirty = myAllRowsDirty = false;
+    myDirtyRows.clear();
 
     // Let postFrameUpdate() know that a change has been made
     return myFB.myDirtyFlag = true;
@@ -170,6 +252,8 @@ void FBSurfaceSDL2::reload()
   SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, myInterpolate ? "1" : "0");
   myTexture = SDL_CreateTexture(myFB.myRenderer, myFB.myPixelFormat->format,
       myTexAccess, mySurface->w, mySurface->h);
+  myAllRowsDirty = true;
+  myDirectAccess = false;
 
   // If the data is static, we only upload it once
   if(myTexAccess == SDL_TEXTUREACCESS_STATIC)
@@ -39,7 +39,12 @@ class FBSurfaceSDL2 : public FBSurface
     //
     void fillRect(uInt32 x, uInt32 y, uInt32 w, uInt32 h, uInt32 color) override;
     // With hardware surfaces, it's faster to just update the entire surface
-    void setDirty() override { mySurfaceIsDirty = true; }
+    void setDirty() override { mySurfaceIsDirty = myAllRowsDirty = true; }
+    // Unless only a few rows of it have changed
+    void setDirtyRows(uInt32 y, uInt32 h) override;
+    // Streaming textures can also be written directly, without a copy
+    bool lockRows(uInt32 y, uInt32 h, uInt32*& pixels, uInt32& pitch) override;
+    void unlockRows() override;
 
     uInt32 width() const override;
     uInt32 height() const override;
@@ -80,6 +85,15 @@ class FBSurfaceSDL2 : public FBSurface
     SDL_Rect mySrcR, myDstR;
 
     bool mySurfaceIsDirty;
+
+    // Rows of the texture which must be updated at the next render, as
+    // (first row, number of rows); only used when not updating all rows
+    bool myAllRowsDirty;
+    vector<std::pair<uInt32, uInt32>> myDirtyRows;
+
+    // The texture is written directly (see lockRows()), so the contents
+    // of the SDL_Surface are out of date and must not be uploaded
+    bool myDirectAccess;
     bool myIsVisible;
 
     SDL_TextureAccess myTexAccess;  // Is pixel data constant or can it change?
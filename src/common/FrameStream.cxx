@@ -0,0 +1,260 @@
+//============================================================================
+//
+//   SSSS    tt          lll  lll
+//  SS  SS   tt           ll   ll
+//  SS     tttttt  eeee   ll   ll   aaaa
+//   SSSS    tt   ee  ee  ll   ll      aa
+//      SS   tt   eeeeee  ll   ll   aaaaa  --  "An Atari 2600 VCS Emulator"
+//  SS  SS   tt   ee      ll   ll  aa  aa
+//   SSSS     ttt  eeeee llll llll  aaaaa
+//
+// Copyright (c) 1995-2017 by Bradford W. Mott, Stephen Anthony
+// and the Stella Team
+//
+// See the file "License.txt" for information on usage and redistribution of
+// this file, and for a DISCLAIMER OF ALL WARRANTIES.
+//============================================================================
+
+#if defined(BSPF_UNIX) || defined(BSPF_MAC_OSX)
+  #include <cerrno>
+  #include <csignal>
+  #include <fcntl.h>
+  #include <poll.h>
+  #include <sys/socket.h>
+  #include <sys/stat.h>
+  #include <sys/un.h>
+  #include <unistd.h>
+  #define STREAM_SUPPORT
+#endif
+
+#include "FrameStream.hxx"
+
+namespace {
+  // Size of the header of each packet
+  constexpr uInt32 kHeaderSize = 32;
+
+  // Packets are little-endian, regardless of the host
+  uInt8* putLE(uInt8* out, uInt32 value, uInt32 bytes)
+  {
+    for(uInt32 i = 0; i < bytes; ++i, value >>= 8)
+      *out++ = uInt8(value & 0xff);
+    return out;
+  }
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+FrameStream::FrameStream(const string& path)
+  : myPath(path),
+    myIsSocket(false),
+    myFd(-1),
+    myHead(0),
+    myCount(0),
+    myQuit(false),
+    myFrames(0),
+    myDropped(0)
+{
+#ifdef STREAM_SUPPORT
+  struct stat st;
+  if(stat(path.c_str(), &st) != 0 ||
+     !(S_ISFIFO(st.st_mode) || S_ISSOCK(st.st_mode)))
+    throw runtime_error("ERROR: " + path + " isn't a named pipe or socket");
+  myIsSocket = S_ISSOCK(st.st_mode);
+
+  myWriter = std::thread(&FrameStream::writerThread, this);
+#else
+  throw runtime_error("ERROR: Streaming isn't supported on this system");
+#endif
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+FrameStream::~FrameStream()
+{
+  close();
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void FrameStream::close()
+{
+  {
+    std::lock_guard<std::mutex> lock(myMutex);
+    myQuit = true;
+  }
+  myPacketReady.notify_one();
+  if(myWriter.joinable())
+    myWriter.join();
+  disconnect();
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void FrameStream::push(uInt32 cycles, const uInt8* pixels, uInt32 width,
+                       uInt32 height, const uInt32* palette,
+                       const Int16* samples, uInt32 count, uInt32 rate)
+{
+  const uInt32 frame = myFrames++;
+
+  // Only this thread adds packets, so the free packet stays free until
+  // it's added to the queue below
+  uInt32 slot;
+  {
+    std::lock_guard<std::mutex> lock(myMutex);
+    if(myCount == kQueueSize)
+    {
+      ++myDropped;
+      return;
+    }
+    slot = (myHead + myCount) % kQueueSize;
+  }
+
+  const uInt32 size = 256 * 4 + width * height + count * 2;
+  vector<uInt8>& packet = myPackets[slot];
+  packet.resize(kHeaderSize + size);
+
+  uInt8* out = packet.data();
+  *out++ = 'S';  *out++ = 'T';  *out++ = 'F';  *out++ = 'R';
+  out = putLE(out, frame, 4);
+  out = putLE(out, cycles, 4);
+  out = putLE(out, width, 2);
+  out = putLE(out, height, 2);
+  out = putLE(out, count, 4);
+  out = putLE(out, rate, 4);
+  out = putLE(out, myDropped, 4);
+  out = putLE(out, size, 4);
+  for(uInt32 i = 0; i < 256; ++i)
+    out = putLE(out, palette[i], 4);
+  memcpy(out, pixels, width * height);
+  out += width * height;
+  for(uInt32 i = 0; i < count; ++i)
+    out = putLE(out, uInt16(samples[i]), 2);
+
+  {
+    std::lock_guard<std::mutex> lock(myMutex);
+    ++myCount;
+  }
+  myPacketReady.notify_one();
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void FrameStream::writerThread()
+{
+#ifdef STREAM_SUPPORT
+  // A write to a pipe nobody reads from anymore then fails, instead of
+  // terminating the program
+  sigset_t pipe;
+  sigemptyset(&pipe);
+  sigaddset(&pipe, SIGPIPE);
+  pthread_sigmask(SIG_BLOCK, &pipe, nullptr);
+#endif
+
+  std::unique_lock<std::mutex> lock(myMutex);
+  for(;;)
+  {
+    myPacketReady.wait(lock, [this]{ return myQuit || myCount > 0; });
+    if(myCount == 0)
+      return;
+
+    const vector<uInt8>& packet = myPackets[myHead];
+    lock.unlock();
+
+    // Frames are only kept while something receives them, so a program
+    // connecting later gets the current frames
+    const bool sent = (myFd >= 0 || (!myQuit && connect())) && write(packet);
+    if(!sent)
+      ++myDropped;
+
+    lock.lock();
+    myHead = (myHead + 1) % kQueueSize;
+    --myCount;
+  }
+}
+
+#ifdef STREAM_SUPPORT
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool FrameStream::connect()
+{
+  if(myIsSocket)
+  {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if(myPath.size() >= sizeof(address.sun_path))
+      return false;
+    strncpy(address.sun_path, myPath.c_str(), sizeof(address.sun_path) - 1);
+
+    myFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(myFd >= 0 && ::connect(myFd,
+         reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0)
+      disconnect();
+  }
+  else
+  {
+    // Without a reader, this fails right away instead of waiting for one
+    myFd = open(myPath.c_str(), O_WRONLY | O_NONBLOCK);
+  }
+
+  if(myFd >= 0)
+    fcntl(myFd, F_SETFL, fcntl(myFd, F_GETFL) | O_NONBLOCK);
+  return myFd >= 0;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool FrameStream::write(const vector<uInt8>& packet)
+{
+  const uInt8* data = packet.data();
+  size_t left = packet.size();
+  while(left > 0)
+  {
+    const ssize_t written = ::write(myFd, data, left);
+    if(written > 0)
+    {
+      data += written;
+      left -= written;
+    }
+    else if(written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+    {
+      // Wait for the other end, checking now and then whether the stream
+      // is being closed; it's then only given a moment to read the rest
+      struct pollfd fds = { myFd, POLLOUT, 0 };
+      if(poll(&fds, 1, 100) == 0 && myQuit)
+        break;
+    }
+    else if(written < 0 && errno == EINTR)
+      continue;
+    else
+      break;
+  }
+
+  // The other end is gone, or has stopped reading; the next packet goes to
+  // whatever connects next, so it mustn't start in the middle of this one
+  if(left > 0)
+    disconnect();
+  return left == 0;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void FrameStream::disconnect()
+{
+  if(myFd >= 0)
+  {
+    ::close(myFd);
+    myFd = -1;
+  }
+}
+
+#else
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool FrameStream::connect()
+{
+  return false;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool FrameStream::write(const vector<uInt8>&)
+{
+  return false;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void FrameStream::disconnect()
+{
+}
+#endif
@@ -0,0 +1,150 @@
+//============================================================================
+//
+//   SSSS    tt          lll  lll
+//  SS  SS   tt           ll   ll
+//  SS     tttttt  eeee   ll   ll   aaaa
+//   SSSS    tt   ee  ee  ll   ll      aa
+//      SS   tt   eeeeee  ll   ll   aaaaa  --  "An Atari 2600 VCS Emulator"
+//  SS  SS   tt   ee      ll   ll  aa  aa
+//   SSSS     ttt  eeeee llll llll  aaaaa
+//
+// Copyright (c) 1995-2017 by Bradford W. Mott, Stephen Anthony
+// and the Stella Team
+//
+// See the file "License.txt" for information on usage and redistribution of
+// this file, and for a DISCLAIMER OF ALL WARRANTIES.
+//============================================================================
+
+#ifndef FRAME_STREAM_HXX
+#define FRAME_STREAM_HXX
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "bspf.hxx"
+
+/**
+  This class sends raw frames and sound to another program, through a
+  named pipe (FIFO) or a UNIX domain socket.  Each frame is sent as one
+  packet, consisting of a 32 byte header followed by the palette, the
+  palette indices of the image and the sound samples of the frame:
+
+    offset  size  contents (all values little-endian)
+       0      4   "STFR"
+       4      4   frame number, counted from the start of the stream
+       8      4   length of the frame in system cycles
+      12      2   width of the image
+      14      2   height of the image
+      16      4   number of sound samples
+      20      4   sample rate
+      24      4   number of frames dropped so far
+      28      4   size of the rest of the packet, in bytes
+
+  then 256 palette entries of 4 bytes (0x00RRGGBB), width * height palette
+  indices and the mono 16-bit samples.
+
+  Packets are queued and written by a separate thread, so emulation never
+  waits for the receiving program.  When the queue is full, or nothing is
+  connected to the other end, frames are dropped and counted instead; gaps
+  in the frame numbers show where this happened.  A program may connect
+  and disconnect at any time, and always starts receiving at a packet.
+
+  @author  Stella Team
+*/
+class FrameStream
+{
+  public:
+    /**
+      Create a stream to the given named pipe or UNIX domain socket.
+      If it isn't one of these, a runtime_error is thrown.
+    */
+    FrameStream(const string& path);
+    ~FrameStream();
+
+    /**
+      Queue a frame for sending, or drop it if the queue is full.
+
+      @param cycles   Length of the frame in system cycles
+      @param pixels   The palette indices of the image
+      @param width    The width of the image
+      @param height   The height of the image
+      @param palette  The RGB palette of the image (256 entries)
+      @param samples  The sound samples of the frame
+      @param count    The number of sound samples
+      @param rate     The sample rate of the sound
+    */
+    void push(uInt32 cycles, const uInt8* pixels, uInt32 width, uInt32 height,
+              const uInt32* palette, const Int16* samples, uInt32 count,
+              uInt32 rate);
+
+    /**
+      Write the packets still queued, as long as the other end takes them,
+      and close the stream.
+    */
+    void close();
+
+    /**
+      Answers the number of frames given to the stream, and how many of
+      them were dropped.
+    */
+    uInt32 frames() const  { return myFrames;  }
+    uInt32 dropped() const { return myDropped; }
+
+  private:
+    /**
+      Main loop of the writer thread.
+    */
+    void writerThread();
+
+    /**
+      Connect to the other end of the pipe or socket, if possible.
+
+      @return  Whether the stream is connected
+    */
+    bool connect();
+
+    /**
+      Write a packet, giving up when the other end is gone, or doesn't
+      accept any data while the stream is being closed.
+
+      @return  Whether the whole packet was written
+    */
+    bool write(const vector<uInt8>& packet);
+
+    /**
+      Close the connection to the other end.
+    */
+    void disconnect();
+
+  private:
+    // Packets are dropped when this many are waiting to be written
+    static constexpr uInt32 kQueueSize = 8;
+
+    string myPath;
+    bool myIsSocket;
+    int myFd;
+
+    // Packets are filled at (myHead + myCount) and written from myHead
+    vector<uInt8> myPackets[kQueueSize];
+    uInt32 myHead, myCount;
+
+    std::thread myWriter;
+    std::mutex myMutex;
+    std::condition_variable myPacketReady;
+    std::atomic<bool> myQuit;
+
+    uInt32 myFrames;
+    std::atomic<uInt32> myDropped;
+
+  private:
+    // Following constructors and assignment operators not supported
+    FrameStream() = delete;
+    FrameStream(const FrameStream&) = delete;
+    FrameStream(FrameStream&&) = delete;
+    FrameStream& operator=(const FrameStream&) = delete;
+    FrameStream& operator=(FrameStream&&) = delete;
+};
+
+#endif
@@ -42,12 +42,19 @@
   #error Unsupported platform!
 #endif
 
-#include "FrameBufferSDL2.hxx"
-#include "EventHandlerSDL2.hxx"
-#ifdef SOUND_SUPPORT
-  #include "SoundSDL2.hxx"
+#if defined(HEADLESS)
+  #include "OSystemHEADLESS.hxx"
+  #include "FrameBufferHEADLESS.hxx"
+  #include "EventHandlerHEADLESS.hxx"
+  #include "SoundHEADLESS.hxx"
 #else
-  #include "SoundNull.hxx"
+  #include "FrameBufferSDL2.hxx"
+  #include "EventHandlerSDL2.hxx"
+  #ifdef SOUND_SUPPORT
+    #include "SoundSDL2.hxx"
+  #else
+    #include "SoundNull.hxx"
+  #endif
 #endif
 
 /**
@@ -66,7 +73,9 @@ class MediaFactory
   public:
     static unique_ptr<OSystem> createOSystem()
     {
-    #if defined(BSPF_UNIX)
+    #if defined(HEADLESS)
+      return make_ptr<OSystemHEADLESS>();
+    #elif defined(BSPF_UNIX)
       return make_ptr<OSystemUNIX>();
     #elif defined(BSPF_WINDOWS)
       return make_ptr<OSystemWINDOWS>();
@@ -105,12 +114,18 @@ class MediaFactory
 
     static unique_ptr<FrameBuffer> createVideo(OSystem& osystem)
     {
+    #if defined(HEADLESS)
+      return make_ptr<FrameBufferHEADLESS>(osystem);
+    #else
       return make_ptr<FrameBufferSDL2>(osystem);
+    #endif
     }
 
     static unique_ptr<Sound> createAudio(OSystem& osystem)
     {
-    #ifdef SOUND_SUPPORT
+    #if defined(HEADLESS)
+      return make_ptr<SoundHEADLESS>(osystem);
+    #elif defined(SOUND_SUPPORT)
       return make_ptr<SoundSDL2>(osystem);
     #else
       return make_ptr<SoundNull>(osystem);
@@ -119,7 +134,11 @@ class MediaFactory
 
     static unique_ptr<EventHandler> createEventHandler(OSystem& osystem)
     {
+    #if defined(HEADLESS)
+      return make_ptr<EventHandlerHEADLESS>(osystem);
+    #else
       return make_ptr<EventHandlerSDL2>(osystem);
+    #endif
     }
 
   private:
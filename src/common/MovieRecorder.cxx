@@ -0,0 +1,423 @@
+//============================================================================
+//
+//   SSSS    tt          lll  lll
+//  SS  SS   tt           ll   ll
+//  SS     tttttt  eeee   ll   ll   aaaa
+//   SSSS    tt   ee  ee  ll   ll      aa
+//      SS   tt   eeeeee  ll   ll   aaaaa  --  "An Atari 2600 VCS Emulator"
+//  SS  SS   tt   ee      ll   ll  aa  aa
+//   SSSS     ttt  eeeee llll llll  aaaaa
+//
+// Copyright (c) 1995-2017 by Bradford W. Mott, Stephen Anthony
+// and the Stella Team
+//
+// See the file "License.txt" for information on usage and redistribution of
+// this file, and for a DISCLAIMER OF ALL WARRANTIES.
+//============================================================================
+
+#include <cmath>
+
+#include "OSystem.hxx"
+#include "Console.hxx"
+#include "FrameBuffer.hxx"
+#include "TIA.hxx"
+#include "TIATypes.hxx"
+#include "FrameStream.hxx"
+#include "MovieRecorder.hxx"
+
+namespace {
+  // TIA sound is generated at this rate, so no resampling is needed
+  constexpr uInt32 kSampleRate = 31400;
+
+  // System cycles per second, as assumed by the sound emulation
+  constexpr double kCyclesPerSecond = 1193191.66666667;
+
+  // Sound samples per system cycle
+  constexpr double kSamplesPerCycle = kSampleRate / kCyclesPerSecond;
+
+  // Size of the RIFF/WAVE header written before the samples
+  constexpr uInt32 kWaveHeaderSize = 44;
+
+  // WAVE files are little-endian, regardless of the host
+  void putLE(std::ofstream& out, uInt32 value, uInt32 bytes)
+  {
+    for(uInt32 i = 0; i < bytes; ++i, value >>= 8)
+      out.put(char(value & 0xff));
+  }
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+MovieRecorder::MovieRecorder(OSystem& osystem)
+  : myOSystem(osystem),
+    myTIA(nullptr),
+    myRecording(false),
+    myWidth(0),
+    myHeight(0),
+    mySound(kSampleRate),
+    mySampleFraction(0.0),
+    myFilling(0),
+    myPalette(nullptr),
+    myPendingBlock(nullptr),
+    myQuit(false),
+    myFrames(0),
+    myRepeats(0),
+    mySamples(0),
+    myCycles(0),
+    myWriteFailed(false)
+{
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+MovieRecorder::~MovieRecorder()
+{
+  stop();
+  stopStream();
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void MovieRecorder::start(const string& basename)
+{
+  stop();
+
+  TIA& tia = myOSystem.console().tia();
+  myWidth  = tia.width();
+  myHeight = std::min(tia.height(), uInt32(FrameManager::frameBufferHeight));
+
+  myVideo.open(basename + ".y4m", std::ios::out | std::ios::binary | std::ios::trunc);
+  myAudio.open(basename + ".wav", std::ios::out | std::ios::binary | std::ios::trunc);
+  if(!myVideo.is_open() || !myAudio.is_open())
+  {
+    myVideo.close();
+    myAudio.close();
+    throw runtime_error("ERROR: Couldn't create recording files");
+  }
+
+  // The frame rate and the sizes in the WAVE header are filled in by stop()
+  myAudio.write("RIFF", 4);  putLE(myAudio, 0, 4);
+  myAudio.write("WAVE", 4);
+  myAudio.write("fmt ", 4);  putLE(myAudio, 16, 4);
+  putLE(myAudio, 1, 2);                   // PCM
+  putLE(myAudio, 1, 2);                   // mono
+  putLE(myAudio, kSampleRate, 4);
+  putLE(myAudio, kSampleRate * 2, 4);     // bytes per second
+  putLE(myAudio, 2, 2);                   // bytes per sample
+  putLE(myAudio, 16, 2);                  // bits per sample
+  myAudio.write("data", 4);  putLE(myAudio, 0, 4);
+  writeVideoHeader(60000);
+
+  attach();
+
+  myPalette = myOSystem.frameBuffer().rgbPalette();
+  for(Block& block: myBlocks)
+  {
+    block.pixels = make_ptr<uInt8[]>(kBlockFrames * myWidth * myHeight);
+    block.stored = block.frames = 0;
+    block.samples.clear();
+    block.samples.reserve(kBlockFrames * kSampleRate / 50 + kBlockFrames);
+  }
+  myFilling = 0;
+  memcpy(myBlocks[0].palette, myPalette, sizeof(myBlocks[0].palette));
+  myLastFrame = make_ptr<uInt8[]>(myWidth * myHeight * 3);
+
+  myFrames = myRepeats = mySamples = 0;
+  myCycles = 0;
+  myWriteFailed = false;
+  myPendingBlock = nullptr;
+  myQuit = false;
+  myWriter = std::thread(&MovieRecorder::writerThread, this);
+  myRecording = true;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+string MovieRecorder::stop()
+{
+  if(!myRecording)
+    return EmptyString;
+
+  myRecording = false;
+  detach();
+
+  // Write the frames collected so far, and wait for the writer to finish
+  if(myBlocks[myFilling].frames > 0)
+    flushBlock();
+  {
+    std::lock_guard<std::mutex> lock(myMutex);
+    myQuit = true;
+  }
+  myBlockReady.notify_one();
+  myWriter.join();
+
+  finishWave();
+  if(myCycles > 0)
+    writeVideoHeader(uInt32(std::round(myFrames * kCyclesPerSecond * 1000 / myCycles)));
+  myVideo.close();
+  myAudio.close();
+
+  for(Block& block: myBlocks)
+    block.pixels.reset();
+  myLastFrame.reset();
+
+  ostringstream buf;
+  if(myWriteFailed)
+    buf << "ERROR: Recording incomplete, couldn't write files";
+  else
+    buf << "Recorded " << myFrames << " frames (" << myRepeats << " repeated)";
+  return buf.str();
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void MovieRecorder::startStream(const string& path)
+{
+  stopStream();
+
+  myStream = make_ptr<FrameStream>(path);
+  attach();
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+string MovieRecorder::stopStream()
+{
+  if(!myStream)
+    return EmptyString;
+
+  myStream->close();
+  ostringstream buf;
+  buf << "Streamed " << myStream->frames() << " frames ("
+      << myStream->dropped() << " dropped)";
+
+  myStream.reset();
+  detach();
+  return buf.str();
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void MovieRecorder::attach()
+{
+  if(myTIA)
+    return;
+
+  // Start the sound from the current register contents
+  TIA& tia = myOSystem.console().tia();
+  mySound.reset();
+  mySound.channels(1, false);
+  for(uInt8 address = AUDC0; address <= AUDV1; ++address)
+    mySound.set(address, tia.registerValue(address));
+  myAudioWrites.clear();
+  mySampleFraction = 0.0;
+
+  myTIA = &tia;
+  myTIA->setRecorder(this);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void MovieRecorder::detach()
+{
+  if(myTIA && !myRecording && !myStream)
+  {
+    myTIA->setRecorder(nullptr);
+    myTIA = nullptr;
+  }
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void MovieRecorder::audioWrite(uInt16 address, uInt8 value, uInt32 cycle)
+{
+  myAudioWrites.push_back({cycle, address, value});
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void MovieRecorder::frameComplete(uInt32 cycles)
+{
+  // Start a new block when the palette changes, since the writer converts
+  // all frames of a block with the same palette
+  const uInt32* palette = myOSystem.frameBuffer().rgbPalette();
+  const bool newPalette = myRecording && palette != myPalette;
+  if(newPalette)
+  {
+    myPalette = palette;
+    if(myBlocks[myFilling].frames > 0)
+      flushBlock();
+    else
+      memcpy(myBlocks[myFilling].palette, myPalette, sizeof(Block::palette));
+  }
+
+  // Generate the samples of this frame, applying each register write
+  // at the sample it occurred in
+  const double end = mySampleFraction + cycles * kSamplesPerCycle;
+  const uInt32 total = uInt32(end);
+  uInt32 produced = 0;
+  myFrameSamples.resize(total);
+  auto generate = [&](uInt32 upto) {
+    if(upto > produced)
+    {
+      mySound.process(&myFrameSamples[produced], upto - produced);
+      produced = upto;
+    }
+  };
+  for(const AudioWrite& write: myAudioWrites)
+  {
+    generate(std::min(uInt32(mySampleFraction + write.cycle * kSamplesPerCycle),
+                      total));
+    mySound.set(write.address, write.value);
+  }
+  generate(total);
+  mySampleFraction = end - total;
+  myAudioWrites.clear();
+
+  // Loading a state changes the registers without any writes; setting a
+  // register to its current value doesn't affect the sound
+  for(uInt8 address = AUDC0; address <= AUDV1; ++address)
+    mySound.set(address, myTIA->registerValue(address));
+
+  if(myStream)
+    myStream->push(cycles, myTIA->currentFrameBuffer(), myTIA->width(),
+                   std::min(myTIA->height(), uInt32(FrameManager::frameBufferHeight)),
+                   palette, myFrameSamples.data(), total, kSampleRate);
+
+  if(!myRecording)
+    return;
+
+  Block& block = myBlocks[myFilling];
+  block.samples.insert(block.samples.end(),
+                       myFrameSamples.begin(), myFrameSamples.end());
+
+  // Identical frames aren't copied; the writer repeats the previous one
+  const bool repeat = myFrames > 0 && !newPalette && !myTIA->frameChanged();
+  if(!repeat)
+  {
+    const uInt32 height = std::min(myHeight, myTIA->height());
+    uInt8* pixels = block.pixels.get() + block.stored * myWidth * myHeight;
+    memcpy(pixels, myTIA->currentFrameBuffer(), myWidth * height);
+    memset(pixels + myWidth * height, 0, myWidth * (myHeight - height));
+    ++block.stored;
+  }
+  else
+    ++myRepeats;
+  block.repeat[block.frames++] = repeat;
+  ++myFrames;
+  myCycles += cycles;
+
+  if(block.frames == kBlockFrames)
+    flushBlock();
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void MovieRecorder::flushBlock()
+{
+  {
+    std::unique_lock<std::mutex> lock(myMutex);
+    myBlockDone.wait(lock, [this]{ return myPendingBlock == nullptr; });
+    myPendingBlock = &myBlocks[myFilling];
+  }
+  myBlockReady.notify_one();
+
+  // The writer is done with the other block, since nothing else is pending
+  myFilling ^= 1;
+  Block& block = myBlocks[myFilling];
+  block.stored = block.frames = 0;
+  block.samples.clear();
+  memcpy(block.palette, myPalette, sizeof(block.palette));
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void MovieRecorder::writerThread()
+{
+  std::unique_lock<std::mutex> lock(myMutex);
+  for(;;)
+  {
+    myBlockReady.wait(lock, [this]{ return myQuit || myPendingBlock; });
+    if(!myPendingBlock)
+      return;
+
+    const Block* block = myPendingBlock;
+    lock.unlock();
+    writeBlock(*block);
+    lock.lock();
+
+    myPendingBlock = nullptr;
+    myBlockDone.notify_one();
+  }
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void MovieRecorder::writeBlock(const Block& block)
+{
+  // Full range BT.601 Y'CbCr of each palette entry
+  uInt8 y[256], cb[256], cr[256];
+  for(int i = 0; i < 256; ++i)
+  {
+    const double r = (block.palette[i] >> 16) & 0xff,
+                 g = (block.palette[i] >> 8) & 0xff,
+                 b = block.palette[i] & 0xff;
+    auto clamp = [](double v) {
+      return uInt8(std::min(std::max(std::round(v), 0.0), 255.0));
+    };
+    y[i]  = clamp( 0.299    * r + 0.587    * g + 0.114    * b);
+    cb[i] = clamp(-0.168736 * r - 0.331264 * g + 0.5      * b + 128);
+    cr[i] = clamp( 0.5      * r - 0.418688 * g - 0.081312 * b + 128);
+  }
+
+  const uInt32 size = myWidth * myHeight;
+  const uInt8* pixels = block.pixels.get();
+  uInt8* planeY  = myLastFrame.get();
+  uInt8* planeCb = planeY + size;
+  uInt8* planeCr = planeCb + size;
+  for(uInt32 frame = 0; frame < block.frames; ++frame)
+  {
+    if(!block.repeat[frame])
+    {
+      for(uInt32 i = 0; i < size; ++i)
+      {
+        const uInt8 index = pixels[i];
+        planeY[i]  = y[index];
+        planeCb[i] = cb[index];
+        planeCr[i] = cr[index];
+      }
+      pixels += size;
+    }
+    myVideo.write("FRAME\n", 6);
+    myVideo.write(reinterpret_cast<const char*>(myLastFrame.get()), size * 3);
+  }
+
+  // Samples are written little-endian
+  string bytes(block.samples.size() * 2, '\0');
+  for(size_t i = 0; i < block.samples.size(); ++i)
+  {
+    bytes[i*2]   = char(block.samples[i] & 0xff);
+    bytes[i*2+1] = char((block.samples[i] >> 8) & 0xff);
+  }
+  myAudio.write(bytes.data(), bytes.size());
+  mySamples += uInt32(block.samples.size());
+
+  if(!myVideo || !myAudio)
+    myWriteFailed = true;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void MovieRecorder::writeVideoHeader(uInt32 rate)
+{
+  // The average frame rate follows from the length of the frames, the same
+  // way the sound does, so that both stay in step.  It's rewritten in place
+  // at the end, so it always has the same number of digits.  The colours
+  // are full range BT.601 4:4:4, so every TIA pixel keeps its exact colour,
+  // and TIA pixels are twice as wide as they are high.
+  myVideo.seekp(0);
+  myVideo << "YUV4MPEG2 W" << myWidth << " H" << myHeight << " F"
+          << std::setw(9) << std::setfill('0') << rate
+          << ":1000 Ip A2:1 C444 XCOLORRANGE=FULL\n";
+  myVideo.seekp(0, std::ios::end);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void MovieRecorder::finishWave()
+{
+  const uInt32 dataSize = mySamples * 2;
+
+  myAudio.seekp(4);
+  putLE(myAudio, kWaveHeaderSize - 8 + dataSize, 4);
+  myAudio.seekp(kWaveHeaderSize - 4);
+  putLE(myAudio, dataSize, 4);
+
+  if(!myAudio)
+    myWriteFailed = true;
+}
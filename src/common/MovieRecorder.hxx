@@ -0,0 +1,229 @@
+//============================================================================
+//
+//   SSSS    tt          lll  lll
+//  SS  SS   tt           ll   ll
+//  SS     tttttt  eeee   ll   ll   aaaa
+//   SSSS    tt   ee  ee  ll   ll      aa
+//      SS   tt   eeeeee  ll   ll   aaaaa  --  "An Atari 2600 VCS Emulator"
+//  SS  SS   tt   ee      ll   ll  aa  aa
+//   SSSS     ttt  eeeee llll llll  aaaaa
+//
+// Copyright (c) 1995-2017 by Bradford W. Mott, Stephen Anthony
+// and the Stella Team
+//
+// See the file "License.txt" for information on usage and redistribution of
+// this file, and for a DISCLAIMER OF ALL WARRANTIES.
+//============================================================================
+
+#ifndef MOVIE_RECORDER_HXX
+#define MOVIE_RECORDER_HXX
+
+class OSystem;
+class TIA;
+class FrameStream;
+
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+#include "TIASnd.hxx"
+#include "bspf.hxx"
+
+/**
+  This class records the emulated TIA image and sound to a pair of files:
+  an uncompressed YUV4MPEG2 video stream (.y4m) and a 16-bit PCM WAVE file
+  (.wav), which can be played and combined by most video tools.
+
+  While recording, the TIA reports each completed frame and each write to
+  the audio registers.  The sound is generated from these writes with a
+  separate TIASound, so it is in step with the frames regardless of the
+  sound device.  Frames are collected as palette indices into blocks, and
+  a full block is handed to a writer thread, which converts and writes it
+  while the next block is filled.  Frames identical to the one before
+  aren't copied at all; the writer simply repeats the previous frame.
+
+  The same frames and sound can also be streamed to another program,
+  independently of the files (see FrameStream).
+
+  @author  Stella Team
+*/
+class MovieRecorder
+{
+  public:
+    MovieRecorder(OSystem& osystem);
+    ~MovieRecorder();
+
+    /**
+      Start recording the current console.
+
+      @param basename  The filename of the recording, without extension
+
+      @return  On success, recording has started, otherwise a runtime_error
+               is thrown containing a more detailed error message.
+    */
+    void start(const string& basename);
+
+    /**
+      Stop recording, and finish writing the files.
+
+      @return  A message describing the recording
+    */
+    string stop();
+
+    /**
+      Start streaming the current console to a named pipe or socket.
+
+      @param path  The path of the pipe or socket
+
+      @return  On success, streaming has started, otherwise a runtime_error
+               is thrown containing a more detailed error message.
+    */
+    void startStream(const string& path);
+
+    /**
+      Stop streaming.
+
+      @return  A message describing the stream
+    */
+    string stopStream();
+
+    /**
+      Answers whether a recording or stream is in progress.
+    */
+    bool isRecording() const { return myRecording; }
+    bool isStreaming() const { return myStream != nullptr; }
+
+    /**
+      Answers whether the TIA output is captured, for a recording and/or
+      a stream.
+    */
+    bool isCapturing() const { return myTIA != nullptr; }
+
+    /**
+      Called by the TIA when one of the audio registers is written.
+
+      @param address  The register address
+      @param value    The value written to the register
+      @param cycle    The system cycle of the write, counted from the
+                      start of the frame
+    */
+    void audioWrite(uInt16 address, uInt8 value, uInt32 cycle);
+
+    /**
+      Called by the TIA after each frame, to record the frame and the
+      sound generated during it.
+
+      @param cycles  The number of system cycles the frame took
+    */
+    void frameComplete(uInt32 cycles);
+
+  private:
+    // The number of frames collected before a block is handed to the writer
+    static constexpr uInt32 kBlockFrames = 32;
+
+    // A group of frames with the sound played during them
+    struct Block {
+      unique_ptr<uInt8[]> pixels;  // palette indices of the frames stored
+      uInt32 stored;               // number of frames in 'pixels'
+      bool repeat[kBlockFrames];   // frame is a copy of the one before
+      uInt32 frames;               // number of frames, including repeats
+      uInt32 palette[256];         // RGB palette of all frames in the block
+      vector<Int16> samples;
+    };
+
+    /**
+      Start capturing the TIA output, if it isn't already.
+    */
+    void attach();
+
+    /**
+      Stop capturing the TIA output, once neither recording nor streaming.
+    */
+    void detach();
+
+    /**
+      Hand the block being filled to the writer thread (waiting until it's
+      done with the one before), and continue with the other block.
+    */
+    void flushBlock();
+
+    /**
+      Main loop of the writer thread.
+    */
+    void writerThread();
+
+    /**
+      Convert the frames of a block to Y'CbCr and write them, along with
+      the sound samples.
+    */
+    void writeBlock(const Block& block);
+
+    /**
+      Write the header of the Y4M stream, with the given frame rate (in
+      frames per 1000 seconds).
+    */
+    void writeVideoHeader(uInt32 rate);
+
+    /**
+      Fill in the sizes of the WAVE header, once all samples are written.
+    */
+    void finishWave();
+
+  private:
+    OSystem& myOSystem;
+
+    // The TIA being captured, or nullptr when neither recording nor streaming
+    TIA* myTIA;
+    bool myRecording;
+
+    // Size of the recorded image; the TIA image is cropped or padded to
+    // the size it had when recording started
+    uInt32 myWidth, myHeight;
+
+    // The output files
+    std::ofstream myVideo, myAudio;
+
+    // The sound, generated from the audio register writes of each frame
+    TIASound mySound;
+    struct AudioWrite {
+      uInt32 cycle;
+      uInt16 address;
+      uInt8 value;
+    };
+    vector<AudioWrite> myAudioWrites;
+    double mySampleFraction;
+    vector<Int16> myFrameSamples;
+
+    // Frames are collected in one block while the other is written
+    Block myBlocks[2];
+    uInt32 myFilling;
+    const uInt32* myPalette;
+
+    std::thread myWriter;
+    std::mutex myMutex;
+    std::condition_variable myBlockReady, myBlockDone;
+    const Block* myPendingBlock;
+    bool myQuit;
+
+    // The writer repeats this (Y'CbCr) frame for identical frames
+    unique_ptr<uInt8[]> myLastFrame;
+
+    // Statistics for the message at the end, and the frame rate
+    uInt32 myFrames, myRepeats, mySamples;
+    uInt64 myCycles;
+    bool myWriteFailed;
+
+    // The stream of frames to another program, if any
+    unique_ptr<FrameStream> myStream;
+
+  private:
+    // Following constructors and assignment operators not supported
+    MovieRecorder() = delete;
+    MovieRecorder(const MovieRecorder&) = delete;
+    MovieRecorder(MovieRecorder&&) = delete;
+    MovieRecorder& operator=(const MovieRecorder&) = delete;
+    MovieRecorder& operator=(MovieRecorder&&) = delete;
+};
+
+#endif
@@ -19,16 +19,35 @@
 #include <cmath>
 
 #include "bspf.hxx"
+#include "OSystem.hxx"
 #include "FrameBuffer.hxx"
+#include "Settings.hxx"
 #include "Props.hxx"
 #include "PNGLibrary.hxx"
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-PNGLibrary::PNGLibrary(const FrameBuffer& fb)
-  : myFB(fb)
+PNGLibrary::PNGLibrary(OSystem& osystem)
+  : myOSystem(osystem),
+    myQuit(false),
+    myHasWriteMessage(false)
 {
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+PNGLibrary::~PNGLibrary()
+{
+  // Images still in the queue are written before the thread exits
+  if(myWriter.joinable())
+  {
+    {
+      std::lock_guard<std::mutex> lock(myMutex);
+      myQuit = true;
+    }
+    myJobReady.notify_one();
+    myWriter.join();
+  }
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void PNGLibrary::loadImage(const string& filename, FBSurface& surface)
 {
@@ -115,36 +134,31 @@ done:
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void PNGLibrary::saveImage(const string& filename, const VariantList& comments)
+void PNGLibrary::saveImage(const string& filename, const VariantList& comments,
+                           const string& saved)
 {
-  ofstream out(filename, std::ios_base::binary);
-  if(!out.is_open())
-    throw runtime_error("ERROR: Couldn't create snapshot file");
-
-  const GUI::Rect& rect = myFB.imageRect();
+  const FrameBuffer& fb = myOSystem.frameBuffer();
+  const GUI::Rect& rect = fb.imageRect();
   png_uint_32 width = rect.width(), height = rect.height();
 
   // Get framebuffer pixel data (we get ABGR format)
-  unique_ptr<png_byte[]> buffer = make_ptr<png_byte[]>(width * height * 4);
-  myFB.readPixels(buffer.get(), width*4, rect);
-
-  // Set up pointers into "buffer" byte array
-  unique_ptr<png_bytep[]> rows = make_ptr<png_bytep[]>(height);
-  for(png_uint_32 k = 0; k < height; ++k)
-    rows[k] = png_bytep(buffer.get() + k*width*4);
-
-  // And save the image
-  saveImage(out, rows, width, height, comments);
+  SaveJob job;
+  job.buffer = make_ptr<png_byte[]>(width * height * 4);
+  fb.readPixels(job.buffer.get(), width*4, rect);
+
+  // And let the writer thread save the image
+  job.width    = width;
+  job.height   = height;
+  job.comments = comments;
+  job.saved    = saved;
+  queueImage(filename, job);
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void PNGLibrary::saveImage(const string& filename, const FBSurface& surface,
-                           const GUI::Rect& rect, const VariantList& comments)
+                           const GUI::Rect& rect, const VariantList& comments,
+                           const string& saved)
 {
-  ofstream out(filename, std::ios_base::binary);
-  if(!out.is_open())
-    throw runtime_error("ERROR: Couldn't create snapshot file");
-
   // Do we want the entire surface or just a section?
   png_uint_32 width = rect.width(), height = rect.height();
   if(rect.empty())
@@ -154,21 +168,137 @@ void PNGLibrary::saveImage(const string& filename, const FBSurface& surface,
   }
 
   // Get the surface pixel data (we get ABGR format)
-  unique_ptr<png_byte[]> buffer = make_ptr<png_byte[]>(width * height * 4);
-  surface.readPixels(buffer.get(), width, rect);
+  SaveJob job;
+  job.buffer = make_ptr<png_byte[]>(width * height * 4);
+  surface.readPixels(job.buffer.get(), width, rect);
+
+  // And let the writer thread save the image
+  job.width    = width;
+  job.height   = height;
+  job.comments = comments;
+  job.saved    = saved;
+  queueImage(filename, job);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void PNGLibrary::saveImage(const string& filename, TIASurface::Image& image,
+                           const VariantList& comments, const string& saved)
+{
+  // The writer thread scales the image into the pixel buffer
+  SaveJob job;
+  job.width    = image.scaledWidth;
+  job.height   = image.scaledHeight;
+  job.image    = std::move(image);
+  job.comments = comments;
+  job.saved    = saved;
+  queueImage(filename, job);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool PNGLibrary::writeResult(string& message)
+{
+  if(!myHasWriteMessage)
+    return false;
+
+  std::lock_guard<std::mutex> lock(myMutex);
+  message = myWriteMessage;
+  myHasWriteMessage = false;
+  return true;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void PNGLibrary::queueImage(const string& filename, SaveJob& job)
+{
+  const Settings& settings = myOSystem.settings();
+  const string& filter = settings.getString("ssfilter");
+
+  std::unique_lock<std::mutex> lock(myMutex);
+  if(myJobs.size() >= kMaxQueuedImages)
+    throw runtime_error("ERROR: Too many snapshots waiting to be saved");
+
+  // The file is created right away, so that the name is taken even before
+  // the image is written
+  job.out.open(filename, std::ios_base::binary);
+  if(!job.out.is_open())
+    throw runtime_error("ERROR: Couldn't create snapshot file");
+
+  job.level    = settings.getInt("sszlevel");
+  job.filters  = filter == "none"  ? PNG_FILTER_NONE :
+                 filter == "sub"   ? PNG_FILTER_SUB  :
+                 filter == "up"    ? PNG_FILTER_UP   :
+                 filter == "avg"   ? PNG_FILTER_AVG  :
+                 filter == "paeth" ? PNG_FILTER_PAETH : PNG_ALL_FILTERS;
+
+  myJobs.push_back(std::move(job));
+  lock.unlock();
+
+  if(!myWriter.joinable())
+    myWriter = std::thread(&PNGLibrary::writerThread, this);
+  myJobReady.notify_one();
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void PNGLibrary::writerThread()
+{
+  std::unique_lock<std::mutex> lock(myMutex);
+  for(;;)
+  {
+    myJobReady.wait(lock, [this]{ return myQuit || !myJobs.empty(); });
+    if(myJobs.empty())
+      return;
+
+    // Compress and write the image without holding up further snapshots
+    SaveJob job = std::move(myJobs.front());
+    myJobs.pop_front();
+    lock.unlock();
+
+    string message = job.saved;
+    try
+    {
+      writeImage(job);
+    }
+    catch(const runtime_error& e)
+    {
+      message = e.what();
+    }
+
+    lock.lock();
+    if(message != "")
+    {
+      myWriteMessage = message;
+      myHasWriteMessage = true;
+    }
+  }
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void PNGLibrary::writeImage(SaveJob& job)
+{
+  if(job.image.pixels)
+  {
+    job.buffer = make_ptr<png_byte[]>(job.width * job.height * 4);
+    TIASurface::scaleImage(job.image,
+                           reinterpret_cast<uInt32*>(job.buffer.get()));
+  }
 
   // Set up pointers into "buffer" byte array
-  unique_ptr<png_bytep[]> rows = make_ptr<png_bytep[]>(height);
-  for(png_uint_32 k = 0; k < height; ++k)
-    rows[k] = png_bytep(buffer.get() + k*width*4);
+  unique_ptr<png_bytep[]> rows = make_ptr<png_bytep[]>(job.height);
+  for(png_uint_32 k = 0; k < job.height; ++k)
+    rows[k] = png_bytep(job.buffer.get() + k*job.width*4);
 
   // And save the image
-  saveImage(out, rows, width, height, comments);
+  saveImage(job.out, rows, job.width, job.height, job.comments,
+            job.level, job.filters);
+
+  job.out.close();
+  if(!job.out)
+    throw runtime_error("ERROR: Couldn't write snapshot file");
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void PNGLibrary::saveImage(ofstream& out, const unique_ptr<png_bytep[]>& rows,
-    png_uint_32 width, png_uint_32 height, const VariantList& comments)
+    png_uint_32 width, png_uint_32 height, const VariantList& comments,
+    int level, int filters)
 {
   #define saveImageERROR(s) { err_message = s; goto done; }
 
@@ -190,6 +320,10 @@ void PNGLibrary::saveImage(ofstream& out, const unique_ptr<png_bytep[]>& rows,
   // Set up the output control
   png_set_write_fn(png_ptr, &out, png_write_data, png_io_flush);
 
+  // Trade file size for speed as requested
+  png_set_compression_level(png_ptr, level);
+  png_set_filter(png_ptr, PNG_FILTER_TYPE_BASE, filters);
+
   // Write PNG header info
   png_set_IHDR(png_ptr, info_ptr, width, height, 8,
       PNG_COLOR_TYPE_RGB, PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT,
@@ -275,13 +409,14 @@ void PNGLibrary::loadImagetoSurface(FBSurface& surface)
   surface.basePtr(s_buf, s_pitch);
   uInt8* i_buf = ReadInfo.buffer.get();
   uInt32 i_pitch = ReadInfo.pitch;
+  const FrameBuffer& fb = myOSystem.frameBuffer();
 
   for(uInt32 irow = 0; irow < ih; ++irow, i_buf += i_pitch, s_buf += s_pitch)
   {
     uInt8*  i_ptr = i_buf;
     uInt32* s_ptr = s_buf;
     for(uInt32 icol = 0; icol < ReadInfo.width; ++icol, i_ptr += 3)
-      *s_ptr++ = myFB.mapRGB(*i_ptr, *(i_ptr+1), *(i_ptr+2));
+      *s_ptr++ = fb.mapRGB(*i_ptr, *(i_ptr+1), *(i_ptr+2));
   }
 }
 
@@ -20,11 +20,18 @@
 
 #include <png.h>
 
-class FrameBuffer;
+class OSystem;
 class FBSurface;
 class Properties;
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <fstream>
+#include <mutex>
+#include <thread>
+
+#include "TIASurface.hxx"
 #include "bspf.hxx"
 
 /**
@@ -32,12 +39,19 @@ class Properties;
   abstracts all the irrelevant details other loading and saving an
   actual image.
 
+  Images are saved in two steps: the pixels are captured (and the file is
+  created) immediately, and then compressed and written to disk by a
+  background thread, so that taking snapshots doesn't hold up emulation.
+  Since the file exists from the start, its name can't be picked again
+  for another image still waiting to be written.
+
   @author  Stephen Anthony
 */
 class PNGLibrary
 {
   public:
-    PNGLibrary(const FrameBuffer& fb);
+    PNGLibrary(OSystem& osystem);
+    ~PNGLibrary();
 
     /**
       Read a PNG image from the specified file into a FBSurface structure,
@@ -59,13 +73,17 @@ class PNGLibrary
 
       @param filename  The filename to save the PNG image
       @param comments  The text comments to add to the PNG image
+      @param saved     The message reported by writeResult() once the
+                       image is written, if any
 
-      @return  On success, the PNG file has been saved to 'filename',
-               otherwise a runtime_error is thrown containing a
-               more detailed error message.
+      @return  On success, the image has been queued to be saved to
+               'filename', otherwise a runtime_error is thrown containing
+               a more detailed error message.  Errors which occur while
+               writing the file are reported by writeResult().
     */
     void saveImage(const string& filename,
-                   const VariantList& comments = EmptyVarList);
+                   const VariantList& comments = EmptyVarList,
+                   const string& saved = EmptyString);
 
     /**
       Save the given surface to a PNG file.
@@ -74,17 +92,76 @@ class PNGLibrary
       @param surface   The surface data for the PNG image
       @param rect      The area of the surface to use
       @param comments  The text comments to add to the PNG image
+      @param saved     The message reported by writeResult() once the
+                       image is written, if any
 
-      @return  On success, the PNG file has been saved to 'filename',
-               otherwise a runtime_error is thrown containing a
-               more detailed error message.
+      @return  On success, the image has been queued to be saved to
+               'filename', otherwise a runtime_error is thrown containing
+               a more detailed error message.  Errors which occur while
+               writing the file are reported by writeResult().
     */
     void saveImage(const string& filename, const FBSurface& surface,
                    const GUI::Rect& rect = GUI::EmptyRect,
-                   const VariantList& comments = EmptyVarList);
+                   const VariantList& comments = EmptyVarList,
+                   const string& saved = EmptyString);
+
+    /**
+      Save a TIA image captured with TIASurface::captureImage() to a PNG
+      file.  The image is scaled as it's shown on the screen by the
+      writer thread, so that the framebuffer isn't used here at all.
+
+      @param filename  The filename to save the PNG image
+      @param image     The captured image, which is moved to the queue
+      @param comments  The text comments to add to the PNG image
+      @param saved     The message reported by writeResult() once the
+                       image is written, if any
+
+      @return  On success, the image has been queued to be saved to
+               'filename', otherwise a runtime_error is thrown containing
+               a more detailed error message.  Errors which occur while
+               writing the file are reported by writeResult().
+    */
+    void saveImage(const string& filename, TIASurface::Image& image,
+                   const VariantList& comments = EmptyVarList,
+                   const string& saved = EmptyString);
+
+    /**
+      Check whether the background thread has written an image with a
+      message to report, or couldn't write an image, since the last call
+      to this method.
+
+      @param message  Set to the message (or error) of the last such image
+      @return  True if there is a message to report
+    */
+    bool writeResult(string& message);
 
   private:
-    const FrameBuffer& myFB;
+    OSystem& myOSystem;
+
+    // An image waiting to be compressed and written by the writer thread
+    struct SaveJob {
+      ofstream out;                   // The file, created when queued
+      string saved;                   // The message to report when written
+      unique_ptr<png_byte[]> buffer;  // ARGB pixels, as read from the surface
+      TIASurface::Image image;        // Or the TIA image to scale first
+      png_uint_32 width, height;
+      VariantList comments;
+      int level, filters;             // zlib compression level and PNG filters
+    };
+
+    // At most this many images are waiting to be written; further snapshots
+    // are refused until the writer thread catches up
+    static constexpr uInt32 kMaxQueuedImages = 8;
+
+    std::deque<SaveJob> myJobs;
+    std::thread myWriter;
+    std::mutex myMutex;
+    std::condition_variable myJobReady;
+    bool myQuit;
+
+    // The last message (or error) to report from the writer thread, if any
+    string myWriteMessage;
+    std::atomic<bool> myHasWriteMessage;
 
     // The following data remains between invocations of allocateStorage,
     // and is only changed when absolutely necessary.
@@ -110,6 +187,27 @@ class PNGLibrary
     */
     bool allocateStorage(png_uint_32 iwidth, png_uint_32 iheight);
 
+    /**
+      Create the file for an image, and queue the image to be saved by
+      the writer thread, starting the thread when necessary.  The zlib
+      compression level and PNG filters are taken from the current settings.
+
+      @param filename  The filename to save the PNG image
+      @param job       The image (either 'buffer' or 'image'), its size,
+                       comments and message, which is moved to the queue
+    */
+    void queueImage(const string& filename, SaveJob& job);
+
+    /**
+      Main loop of the writer thread.
+    */
+    void writerThread();
+
+    /**
+      Compress and write a queued image to its file.
+    */
+    void writeImage(SaveJob& job);
+
     /** The actual method which saves a PNG image.
 
       @param out      The output stream for writing PNG data
@@ -117,10 +215,12 @@ class PNGLibrary
       @param width    The width of the PNG image
       @param height   The height of the PNG image
       @param comments The text comments to add to the PNG image
+      @param level    The zlib compression level (0 - 9)
+      @param filters  The PNG filters to choose from for each row
     */
     void saveImage(ofstream& out, const unique_ptr<png_bytep[]>& rows,
                    png_uint_32 width, png_uint_32 height,
-                   const VariantList& comments);
+                   const VariantList& comments, int level, int filters);
 
     /**
       Load the PNG data from 'ReadInfo' into the FBSurface.  The surface
@@ -18,6 +18,8 @@
 #ifndef SDL_LIB_HXX
 #define SDL_LIB_HXX
 
+#ifdef SDL_SUPPORT
+
 #include <SDL.h>
 
 /*
@@ -29,4 +31,18 @@
 #undef pixel
 #undef bool
 
+#else
+
+/*
+  Backends that don't use SDL (ie, the headless build) still share code
+  which refers to the basic SDL integer types, so we provide them here
+*/
+#include <cstdint>
+
+using Uint8  = uint8_t;
+using Uint16 = uint16_t;
+using Uint32 = uint32_t;
+
+#endif  // SDL_SUPPORT
+
 #endif
@@ -39,7 +39,7 @@ class SoundNull : public Sound
     */
     SoundNull(OSystem& osystem) : Sound(osystem)
     {
-      myOSystem->logMessage("Sound disabled.\n", 1);
+      myOSystem.logMessage("Sound disabled.\n", 1);
     }
 
     /**
@@ -129,6 +129,12 @@ class SoundNull : public Sound
     */
     void adjustVolume(Int8 direction) override { }
 
+    // Nothing is played, so there is no latency
+    uInt32 latency() const override { return 0; }
+
+    // The sample rate is never adjusted
+    double rateAdjust() const override { return 0.0; }
+
   public:
     /**
       Saves the current state of this device to the given Serializer.
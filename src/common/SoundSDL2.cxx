@@ -19,7 +19,6 @@
 
 #include <sstream>
 #include <cassert>
-#include <cmath>
 
 #include "SDL_lib.hxx"
 #include "TIASnd.hxx"
@@ -37,12 +36,17 @@ SoundSDL2::SoundSDL2(OSystem& osystem)
     myIsEnabled(false),
     myIsInitializedFlag(false),
     myLastRegisterSetCycle(0),
+    myCyclesToSamples(0.0),
+    mySampleFraction(0.0),
     myNumChannels(0),
-    myFragmentSizeLogBase2(0),
-    myFragmentSizeLogDiv1(0),
-    myFragmentSizeLogDiv2(0),
     myIsMuted(true),
-    myVolume(100)
+    myVolume(100),
+    myStartLevel(0),
+    myFillLevel(0.0),
+    myDrift(0.0),
+    myRatio(1.0),
+    myIsPlaying(false),
+    myLastSample{0, 0}
 {
   myOSystem.logMessage("SoundSDL2::SoundSDL2 started ...", 2);
 
@@ -80,11 +84,6 @@ SoundSDL2::SoundSDL2(OSystem& osystem)
     return;
   }
 
-  // Pre-compute fragment-related variables as much as possible
-  myFragmentSizeLogBase2 = log(myHardwareSpec.samples) / log(2.0);
-  myFragmentSizeLogDiv1 = myFragmentSizeLogBase2 / 60.0;
-  myFragmentSizeLogDiv2 = (myFragmentSizeLogBase2 - 1) / 60.0;
-
   myIsInitializedFlag = true;
   SDL_PauseAudio(1);
 
@@ -127,6 +126,24 @@ void SoundSDL2::open()
   myTIASound.outputFrequency(myHardwareSpec.freq);
   const string& chanResult =
       myTIASound.channels(myHardwareSpec.channels, myNumChannels == 2);
+  myCyclesToSamples = myHardwareSpec.freq / 1193191.66666667;
+  mySampleFraction = 0.0;
+  myDrift = 0.0;
+  myRatio = 1.0;
+
+  // The samples of a frame are generated in a burst, so playback starts
+  // once a bit more than a frame is buffered, plus two fragments, since
+  // the callback takes a whole fragment at a time; there's room for
+  // twice that
+  const uInt32 frame = myHardwareSpec.freq / 50;
+  const uInt32 start = frame + frame / 4 + 2 * myHardwareSpec.samples;
+  uInt32 capacity = 1;
+  while(capacity < 2 * start)
+    capacity <<= 1;
+  myStartLevel = start * myHardwareSpec.channels;
+  myBuffer.resize(capacity * myHardwareSpec.channels);
+  myIsPlaying = false;
+  myFillLevel = myStartLevel;
 
   // Adjust volume to that defined in settings
   myVolume = myOSystem.settings().getInt("volume");
@@ -159,7 +176,7 @@ void SoundSDL2::close()
     SDL_PauseAudio(1);
     myLastRegisterSetCycle = 0;
     myTIASound.reset();
-    myRegWriteQueue.clear();
+    emptyBuffer();
     myOSystem.logMessage("SoundSDL2::close", 2);
   }
 }
@@ -171,6 +188,11 @@ void SoundSDL2::mute(bool state)
   {
     myIsMuted = state;
     SDL_PauseAudio(myIsMuted ? 1 : 0);
+
+    // No samples are generated while muted, so those from before would
+    // be played out of step after unmuting
+    if(myIsMuted)
+      emptyBuffer();
   }
 }
 
@@ -182,7 +204,7 @@ void SoundSDL2::reset()
     SDL_PauseAudio(1);
     myLastRegisterSetCycle = 0;
     myTIASound.reset();
-    myRegWriteQueue.clear();
+    emptyBuffer();
     mute(myIsMuted);
   }
 }
@@ -193,10 +215,8 @@ void SoundSDL2::setVolume(Int32 percent)
   if(myIsInitializedFlag && (percent >= 0) && (percent <= 100))
   {
     myOSystem.settings().setValue("volume", percent);
-    SDL_LockAudio();
     myVolume = percent;
     myTIASound.volume(percent);
-    SDL_UnlockAudio();
   }
 }
 
@@ -229,7 +249,12 @@ void SoundSDL2::adjustVolume(Int8 direction)
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void SoundSDL2::adjustCycleCounter(Int32 amount)
 {
+  // The cycle counter is reset at the end of each frame, so this is where
+  // the rest of the frame is generated
+  generate(-amount);
   myLastRegisterSetCycle += amount;
+
+  updateRate();
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -240,118 +265,119 @@ void SoundSDL2::setChannels(uInt32 channels)
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void SoundSDL2::setFrameRate(float framerate)
+void SoundSDL2::set(uInt16 addr, uInt8 value, Int32 cycle)
 {
-  // Recalculate since frame rate has changed
-  // FIXME - should we clear out the queue or adjust the values in it?
-  myFragmentSizeLogDiv1 = myFragmentSizeLogBase2 / framerate;
-  myFragmentSizeLogDiv2 = (myFragmentSizeLogBase2 - 1) / framerate;
+  // The samples before the write are generated with the old value, so the
+  // write takes effect at the sample it occurs in
+  generate(cycle);
+  myTIASound.set(addr, value);
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void SoundSDL2::set(uInt16 addr, uInt8 value, Int32 cycle)
+void SoundSDL2::generate(Int32 cycle)
 {
-  SDL_LockAudio();
-
-  // First, calculate how many seconds would have past since the last
-  // register write on a real 2600
-  double delta = double(cycle - myLastRegisterSetCycle) / 1193191.66666667;
-
-  // Now, adjust the time based on the frame rate the user has selected. For
-  // the sound to "scale" correctly, we have to know the games real frame
-  // rate (e.g., 50 or 60) and the currently emulated frame rate. We use these
-  // values to "scale" the time before the register change occurs.
-  RegWrite info;
-  info.addr = addr;
-  info.value = value;
-  info.delta = delta;
-  myRegWriteQueue.enqueue(info);
-
-  // Update last cycle counter to the current cycle
+  const double samples =
+      mySampleFraction + (cycle - myLastRegisterSetCycle) * myCyclesToSamples;
   myLastRegisterSetCycle = cycle;
+  if(samples <= 0.0)
+    return;
+
+  uInt32 count = uInt32(samples);
+  mySampleFraction = samples - count;
+
+  // While muted (e.g. in turbo mode), the callback isn't reading samples
+  if(!myIsEnabled || myIsMuted)
+    return;
+
+  // When the buffer is full, the rest is dropped
+  const uInt32 channels = myHardwareSpec.channels;
+  count *= channels;
+  while(count > 0)
+  {
+    uInt32 length = count;
+    Int16* buffer = myBuffer.prepare(length);
+    if(length == 0)
+      break;
+
+    myTIASound.process(buffer, length / channels);
+    myBuffer.commit(length);
+    count -= length;
+  }
+}
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void SoundSDL2::updateRate()
+{
+  // At most this much faster or slower, which isn't audible
+  constexpr double kMaxAdjust = 0.005;
+
+  if(!myIsEnabled || myIsMuted)
+    return;
+
+  // The level is measured at the same point of each frame, right after
+  // the frame's samples were added; smoothing takes out the jitter from
+  // the fragments taken by the callback
+  myFillLevel += 0.1 * (myBuffer.size() - myFillLevel);
+
+  // Correct in proportion to the error; the difference between the clocks
+  // is learned slowly, so that the level settles at the target instead of
+  // just below or above it
+  const double error = BSPF::clamp(
+      (myStartLevel - myFillLevel) / myStartLevel, -1.0, 1.0);
+  myDrift = BSPF::clamp(myDrift + error / 10000, -kMaxAdjust, kMaxAdjust);
+  myRatio = 1.0 + BSPF::clamp(kMaxAdjust * error + myDrift,
+                              -kMaxAdjust, kMaxAdjust);
+  myCyclesToSamples = myHardwareSpec.freq * myRatio / 1193191.66666667;
+  myTIASound.adjustFrequency(myRatio);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+uInt32 SoundSDL2::latency() const
+{
+  if(!myIsEnabled || myIsMuted)
+    return 0;
+
+  // On average, half a frame less than measured at the end of a frame is
+  // buffered, plus the fragment the device is playing
+  const double samples = myFillLevel / myHardwareSpec.channels -
+      myHardwareSpec.freq / 120.0 + myHardwareSpec.samples;
+  return uInt32(std::max(samples, 0.0) * 1000 / myHardwareSpec.freq);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void SoundSDL2::emptyBuffer()
+{
+  SDL_LockAudio();
+  myBuffer.clear();
+  myIsPlaying = false;
   SDL_UnlockAudio();
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void SoundSDL2::processFragment(Int16* stream, uInt32 length)
 {
-  uInt32 channels = myHardwareSpec.channels;
-  length = length / channels;
-
-  // If there are excessive items on the queue then we'll remove some
-  if(myRegWriteQueue.duration() > myFragmentSizeLogDiv1)
-  {
-    double removed = 0.0;
-    while(removed < myFragmentSizeLogDiv2)
-    {
-      RegWrite& info = myRegWriteQueue.front();
-      removed += info.delta;
-      myTIASound.set(info.addr, info.value);
-      myRegWriteQueue.dequeue();
-    }
-  }
+  const uInt32 channels = myHardwareSpec.channels;
 
-  double position = 0.0;
-  double remaining = length;
+  if(!myIsPlaying && myBuffer.size() >= myStartLevel)
+    myIsPlaying = true;
 
-  while(remaining > 0.0)
+  uInt32 played = 0;
+  if(myIsPlaying)
   {
-    if(myRegWriteQueue.size() == 0)
-    {
-      // There are no more pending TIA sound register updates so we'll
-      // use the current settings to finish filling the sound fragment
-      myTIASound.process(stream + (uInt32(position) * channels),
-          length - uInt32(position));
-
-      // Since we had to fill the fragment we'll reset the cycle counter
-      // to zero.  NOTE: This isn't 100% correct, however, it'll do for
-      // now.  We should really remember the overrun and remove it from
-      // the delta of the next write.
-      myLastRegisterSetCycle = 0;
-      break;
-    }
-    else
-    {
-      // There are pending TIA sound register updates so we need to
-      // update the sound buffer to the point of the next register update
-      RegWrite& info = myRegWriteQueue.front();
-
-      // How long will the remaining samples in the fragment take to play
-      double duration = remaining / myHardwareSpec.freq;
-
-      // Does the register update occur before the end of the fragment?
-      if(info.delta <= duration)
-      {
-        // If the register update time hasn't already passed then
-        // process samples upto the point where it should occur
-        if(info.delta > 0.0)
-        {
-          // Process the fragment upto the next TIA register write.  We
-          // round the count passed to process up if needed.
-          double samples = (myHardwareSpec.freq * info.delta);
-          myTIASound.process(stream + (uInt32(position) * channels),
-              uInt32(samples) + uInt32(position + samples) -
-              (uInt32(position) + uInt32(samples)));
-
-          position += samples;
-          remaining -= samples;
-        }
-        myTIASound.set(info.addr, info.value);
-        myRegWriteQueue.dequeue();
-      }
-      else
-      {
-        // The next register update occurs in the next fragment so finish
-        // this fragment with the current TIA settings and reduce the register
-        // update delay by the corresponding amount of time
-        myTIASound.process(stream + (uInt32(position) * channels),
-            length - uInt32(position));
-        info.delta -= duration;
-        break;
-      }
-    }
+    played = myBuffer.read(stream, length);
+    if(played >= channels)
+      for(uInt32 c = 0; c < channels; ++c)
+        myLastSample[c] = stream[played - channels + c];
+
+    // Ran out of samples; wait until there are enough again, instead of
+    // playing each one as soon as it arrives
+    if(played < length)
+      myIsPlaying = false;
   }
+
+  // Holding the last sample avoids clicks
+  for(uInt32 i = played; i < length; ++i)
+    stream[i] = myLastSample[i % channels];
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -410,18 +436,17 @@ bool SoundSDL2::load(Serializer& in)
       return false;
 
     // Only update the TIA sound registers if sound is enabled
-    // Make sure to empty the queue of previous sound fragments
+    // The callback only reads the samples already generated, so playback
+    // goes on; these were emulated before the load, and are played out
+    // like any others (rewinding loads a state every frame)
     if(myIsInitializedFlag)
     {
-      SDL_PauseAudio(1);
-      myRegWriteQueue.clear();
       myTIASound.set(TIARegister::AUDC0, in.getByte());
       myTIASound.set(TIARegister::AUDC1, in.getByte());
       myTIASound.set(TIARegister::AUDF0, in.getByte());
       myTIASound.set(TIARegister::AUDF1, in.getByte());
       myTIASound.set(TIARegister::AUDV0, in.getByte());
       myTIASound.set(TIARegister::AUDV1, in.getByte());
-      if(!myIsMuted) SDL_PauseAudio(0);
     }
     else
       for(int i = 0; i < 6; ++i)
@@ -439,80 +464,38 @@ bool SoundSDL2::load(Serializer& in)
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-SoundSDL2::RegWriteQueue::RegWriteQueue(uInt32 capacity)
-  : myBuffer(make_ptr<RegWrite[]>(capacity)),
-    myCapacity(capacity),
-    mySize(0),
-    myHead(0),
-    myTail(0)
-{
-}
-
-// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void SoundSDL2::RegWriteQueue::clear()
+void SoundSDL2::SampleRing::resize(uInt32 capacity)
 {
-  myHead = myTail = mySize = 0;
+  myBuffer = make_ptr<Int16[]>(capacity);
+  myCapacity = capacity;
+  clear();
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void SoundSDL2::RegWriteQueue::dequeue()
+Int16* SoundSDL2::SampleRing::prepare(uInt32& count)
 {
-  if(mySize > 0)
-  {
-    myHead = (myHead + 1) % myCapacity;
-    --mySize;
-  }
-}
+  const uInt32 write = myWrite.load(std::memory_order_relaxed);
+  const uInt32 position = write & (myCapacity - 1);
+  const uInt32 space = myCapacity - (write - myRead.load());
 
-// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-double SoundSDL2::RegWriteQueue::duration() const
-{
-  double duration = 0.0;
-  for(uInt32 i = 0; i < mySize; ++i)
-  {
-    duration += myBuffer[(myHead + i) % myCapacity].delta;
-  }
-  return duration;
-}
-
-// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void SoundSDL2::RegWriteQueue::enqueue(const RegWrite& info)
-{
-  // If an attempt is made to enqueue more than the queue can hold then
-  // we'll enlarge the queue's capacity.
-  if(mySize == myCapacity)
-    grow();
-
-  myBuffer[myTail] = info;
-  myTail = (myTail + 1) % myCapacity;
-  ++mySize;
-}
-
-// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-SoundSDL2::RegWrite& SoundSDL2::RegWriteQueue::front() const
-{
-  assert(mySize != 0);
-  return myBuffer[myHead];
-}
-
-// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-uInt32 SoundSDL2::RegWriteQueue::size() const
-{
-  return mySize;
+  count = std::min(count, std::min(space, myCapacity - position));
+  return &myBuffer[position];
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void SoundSDL2::RegWriteQueue::grow()
+uInt32 SoundSDL2::SampleRing::read(Int16* buffer, uInt32 count)
 {
-  unique_ptr<RegWrite[]> buffer = make_ptr<RegWrite[]>(myCapacity*2);
-  for(uInt32 i = 0; i < mySize; ++i)
-    buffer[i] = myBuffer[(myHead + i) % myCapacity];
+  const uInt32 read = myRead.load(std::memory_order_relaxed);
+  count = std::min(count, myWrite.load() - read);
 
-  myHead = 0;
-  myTail = mySize;
-  myCapacity *= 2;
+  // Copy in (at most) two parts, since the samples may wrap around
+  const uInt32 position = read & (myCapacity - 1);
+  const uInt32 first = std::min(count, myCapacity - position);
+  memcpy(buffer, &myBuffer[position], first * sizeof(Int16));
+  memcpy(buffer + first, &myBuffer[0], (count - first) * sizeof(Int16));
 
-  myBuffer = std::move(buffer);
+  myRead.store(read + count);
+  return count;
 }
 
 #endif  // SOUND_SUPPORT
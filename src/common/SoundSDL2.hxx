@@ -22,6 +22,8 @@
 
 class OSystem;
 
+#include <atomic>
+
 #include "SDL_lib.hxx"
 
 #include "bspf.hxx"
@@ -31,6 +33,18 @@ class OSystem;
 /**
   This class implements the sound API for SDL.
 
+  Samples are generated on the emulation thread as the TIA runs: each
+  register write first generates the samples up to the system cycle it
+  occurs at, and the rest of the frame is generated when the frame ends.
+  The samples are passed to the SDL callback through a lock-free ring
+  buffer, which the callback only reads from.
+
+  The emulation and the sound device run from different clocks, so the
+  number of samples buffered would drift.  Instead, the sample rate is
+  adjusted slightly after each frame, to keep the buffer at a steady
+  level (dynamic rate control).  This allows small fragment sizes without
+  running out of samples.
+
   @author Stephen Anthony and Bradford W. Mott
 */
 class SoundSDL2 : public Sound
@@ -75,12 +89,12 @@ class SoundSDL2 : public Sound
     void setChannels(uInt32 channels) override;
 
     /**
-      Sets the display framerate.  Sound generation for NTSC and PAL games
-      depends on the framerate, so we need to set it here.
+      Sets the display framerate.  Samples are generated from the system
+      cycles, so this isn't needed.
 
       @param framerate The base framerate depending on NTSC or PAL ROM
     */
-    void setFrameRate(float framerate) override;
+    void setFrameRate(float framerate) override { }
 
     /**
       Initializes the sound device.  This must be called before any
@@ -132,6 +146,21 @@ class SoundSDL2 : public Sound
     */
     void adjustVolume(Int8 direction) override;
 
+    /**
+      Answers the time from generating a sample until it's played.
+
+      @return  The latency in milliseconds, or 0 when no sound is played
+    */
+    uInt32 latency() const override;
+
+    /**
+      Answers how much the sample rate is currently adjusted, to keep the
+      sound in step with the emulation.
+
+      @return  The adjustment, in percent
+    */
+    double rateAdjust() const override { return (myRatio - 1.0) * 100; }
+
   public:
     /**
       Saves the current state of this device to the given Serializer.
@@ -157,6 +186,25 @@ class SoundSDL2 : public Sound
     string name() const override { return "TIASound"; }
 
   protected:
+    /**
+      Generate the samples up to the given system cycle, and add them to
+      the ring buffer.
+
+      @param cycle  The system cycle to generate samples up to
+    */
+    void generate(Int32 cycle);
+
+    /**
+      Discard the samples not played yet, and wait for new ones before
+      playing again.
+    */
+    void emptyBuffer();
+
+    /**
+      Adjust the sample rate according to the number of samples buffered.
+    */
+    void updateRate();
+
     /**
       Invoked by the sound callback to process the next sound fragment.
       The stream is 16-bits (even though the callback is 8-bits), since
@@ -168,80 +216,71 @@ class SoundSDL2 : public Sound
     void processFragment(Int16* stream, uInt32 length);
 
   protected:
-    // Struct to hold information regarding a TIA sound register write
-    struct RegWrite
-    {
-      uInt16 addr;
-      uInt8 value;
-      double delta;
-    };
-
     /**
-      A queue class used to hold TIA sound register writes before being
-      processed while creating a sound fragment.
+      A ring buffer of samples, written by the emulation thread and read by
+      the sound callback.  Each side only moves its own position, so no
+      locking is needed, as long as there's only one of each.
     */
-    class RegWriteQueue
+    class SampleRing
     {
       public:
-        /**
-          Create a new queue instance with the specified initial
-          capacity.  If the queue ever reaches its capacity then it will
-          automatically increase its size.
-        */
-        RegWriteQueue(uInt32 capacity = 512);
+        SampleRing() : myCapacity(0), myRead(0), myWrite(0) { }
 
-      public:
         /**
-          Clear any items stored in the queue.
+          Set the capacity (a power of 2) and empty the buffer.  Neither side
+          may use the buffer meanwhile.
         */
-        void clear();
+        void resize(uInt32 capacity);
 
         /**
-          Dequeue the first object in the queue.
+          Empty the buffer.  Neither side may use the buffer meanwhile.
         */
-        void dequeue();
+        void clear() { myRead = myWrite = 0; }
 
         /**
-          Return the duration of all the items in the queue.
+          Answers the number of samples in the buffer.
         */
-        double duration() const;
+        uInt32 size() const { return myWrite - myRead; }
 
         /**
-          Enqueue the specified object.
+          Get the space to write the next samples to (writer side).
+
+          @param count  The number of samples wanted; on return, the number
+                        that can be written at the returned location
+
+          @return  The location to write the samples to
         */
-        void enqueue(const RegWrite& info);
+        Int16* prepare(uInt32& count);
 
         /**
-          Return the item at the front on the queue.
-
-          @return  The item at the front of the queue.
+          Add the samples written to the space from prepare() (writer side).
         */
-        RegWrite& front() const;
+        void commit(uInt32 count) { myWrite.store(myWrite + count); }
 
         /**
-          Answers the number of items currently in the queue.
+          Remove samples from the buffer (reader side).
 
-          @return  The number of items in the queue.
-        */
-        uInt32 size() const;
+          @param buffer  The location to copy the samples to
+          @param count   The number of samples wanted
 
-      private:
-        // Increase the size of the queue
-        void grow();
+          @return  The number of samples copied
+        */
+        uInt32 read(Int16* buffer, uInt32 count);
 
       private:
-        unique_ptr<RegWrite[]> myBuffer;
+        unique_ptr<Int16[]> myBuffer;
         uInt32 myCapacity;
-        uInt32 mySize;
-        uInt32 myHead;
-        uInt32 myTail;
+
+        // Total number of samples read and written; the positions in the
+        // buffer are these modulo the capacity
+        std::atomic<uInt32> myRead, myWrite;
 
       private:
         // Following constructors and assignment operators not supported
-        RegWriteQueue(const RegWriteQueue&) = delete;
-        RegWriteQueue(RegWriteQueue&&) = delete;
-        RegWriteQueue& operator=(const RegWriteQueue&) = delete;
-        RegWriteQueue& operator=(RegWriteQueue&&) = delete;
+        SampleRing(const SampleRing&) = delete;
+        SampleRing(SampleRing&&) = delete;
+        SampleRing& operator=(const SampleRing&) = delete;
+        SampleRing& operator=(SampleRing&&) = delete;
     };
 
   private:
@@ -254,21 +293,16 @@ class SoundSDL2 : public Sound
     // Indicates if the sound device was successfully initialized
     bool myIsInitializedFlag;
 
-    // Indicates the cycle when a sound register was last set
+    // Indicates the cycle up to which samples have been generated
     Int32 myLastRegisterSetCycle;
 
+    // Samples generated per system cycle, and the part of a sample left
+    // over from the last call to generate()
+    double myCyclesToSamples, mySampleFraction;
+
     // Indicates the number of channels (mono or stereo)
     uInt32 myNumChannels;
 
-    // Log base 2 of the selected fragment size
-    double myFragmentSizeLogBase2;
-
-    // The myFragmentSizeLogBase2 variable is used in only two places,
-    // both of which involve an expensive division in the sound
-    // processing callback
-    // These are pre-computed to speed up the callback as much as possible
-    double myFragmentSizeLogDiv1, myFragmentSizeLogDiv2;
-
     // Indicates if the sound is currently muted
     bool myIsMuted;
 
@@ -278,8 +312,20 @@ class SoundSDL2 : public Sound
     // Audio specification structure
     SDL_AudioSpec myHardwareSpec;
 
-    // Queue of TIA register writes
-    RegWriteQueue myRegWriteQueue;
+    // Samples generated, but not played yet
+    SampleRing myBuffer;
+
+    // After running out of samples, the callback waits until this many
+    // are buffered again; meanwhile it repeats the last sample played.
+    // The rate control keeps the buffer around this level.
+    uInt32 myStartLevel;
+
+    // The (smoothed) number of samples buffered at the end of a frame, the
+    // part of the rate adjustment that makes up for the difference between
+    // the clocks, and the resulting adjustment of the sample rate
+    double myFillLevel, myDrift, myRatio;
+    bool myIsPlaying;
+    Int16 myLastSample[2];
 
   private:
     // Callback function invoked by the SDL Audio library when it needs data
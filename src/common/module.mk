@@ -3,15 +3,23 @@ MODULE := src/common
 MODULE_OBJS := \
 	src/common/main.o \
 	src/common/Base.o \
-	src/common/EventHandlerSDL2.o \
-	src/common/FrameBufferSDL2.o \
-	src/common/FBSurfaceSDL2.o \
-	src/common/SoundSDL2.o \
 	src/common/FSNodeZIP.o \
 	src/common/PNGLibrary.o \
+	src/common/MovieRecorder.o \
+	src/common/FrameStream.o \
 	src/common/MouseControl.o \
 	src/common/ZipHandler.o
 
+# The SDL2 backends are replaced by those in src/headless for the
+# headless build
+ifndef HEADLESS
+MODULE_OBJS += \
+	src/common/EventHandlerSDL2.o \
+	src/common/FrameBufferSDL2.o \
+	src/common/FBSurfaceSDL2.o \
+	src/common/SoundSDL2.o
+endif
+
 MODULE_DIRS += \
 	src/common
 
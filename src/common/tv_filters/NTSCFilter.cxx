@@ -15,7 +15,6 @@
 // this file, and for a DISCLAIMER OF ALL WARRANTIES.
 //============================================================================
 
-#include "TIASurface.hxx"
 #include "Settings.hxx"
 
 #include "NTSCFilter.hxx"
@@ -24,39 +23,32 @@
 NTSCFilter::NTSCFilter()
   : mySetup(atari_ntsc_composite),
     myPreset(PRESET_OFF),
-    myCurrentAdjustable(0)
+    myCurrentAdjustable(0),
+    myThreads(1),
+    mySIMD(true),
+    myJobId(0),
+    myBandsLeft(0),
+    myQuit(false)
 {
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void NTSCFilter::setTIAPalette(const TIASurface& tiaSurface, const uInt32* palette)
+NTSCFilter::~NTSCFilter()
+{
+  stopWorkers();
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void NTSCFilter::setTIAPalette(const uInt32* palette)
 {
   // Normal TIA palette contains 256 colours, where every odd indexed colour
   // is used for PAL colour-loss effect
   // This can't be emulated here, since the memory requirements would be too
-  // great (a 4x increase)
+  // great (a 2x increase)
   // Therefore, we need to skip every second index, since the array passed to
   // the Blargg code assumes 128 colours
   uInt8* ptr = myTIAPalette;
 
-  // Set palette for phosphor effect
-  for(int i = 0; i < 256; i+=2)
-  {
-    for(int j = 0; j < 256; j+=2)
-    {
-      uInt8 ri = (palette[i] >> 16) & 0xff;
-      uInt8 gi = (palette[i] >> 8) & 0xff;
-      uInt8 bi = palette[i] & 0xff;
-      uInt8 rj = (palette[j] >> 16) & 0xff;
-      uInt8 gj = (palette[j] >> 8) & 0xff;
-      uInt8 bj = palette[j] & 0xff;
-
-      *ptr++ = tiaSurface.getPhosphor(ri, rj);
-      *ptr++ = tiaSurface.getPhosphor(gi, gj);
-      *ptr++ = tiaSurface.getPhosphor(bi, bj);
-    }
-  }
-  // Set palette for normal fill
   for(int i = 0; i < 256; i+=2)
   {
     *ptr++ = (palette[i] >> 16) & 0xff;
@@ -194,6 +186,118 @@ void NTSCFilter::loadConfig(const Settings& settings)
   myCustomSetup.artifacts = BSPF::clamp(settings.getFloat("tv.artifacts"), -1.0f, 1.0f);
   myCustomSetup.fringing = BSPF::clamp(settings.getFloat("tv.fringing"), -1.0f, 1.0f);
   myCustomSetup.bleed = BSPF::clamp(settings.getFloat("tv.bleed"), -1.0f, 1.0f);
+
+  setThreads(settings.getInt("tv.threads"));
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void NTSCFilter::blit_single(uInt8* src_buf, int src_width, int src_height,
+                             uInt32* dest_buf, long dest_pitch)
+{
+  const uInt32 bands = std::min(myThreads, uInt32(src_height / kMinBandHeight));
+
+  if(bands <= 1)
+  {
+    (mySIMD ? atari_ntsc_blit_single : atari_ntsc_blit_single_scalar)(
+        &myFilter, src_buf, src_width, src_width, src_height, dest_buf, dest_pitch);
+    return;
+  }
+
+  if(myWorkers.size() + 1 != myThreads)
+    startWorkers();
+
+  {
+    std::lock_guard<std::mutex> lock(myMutex);
+    myJob = BlitJob{src_buf, src_width, src_height, dest_buf, dest_pitch, bands};
+    myBandsLeft = bands - 1;
+    ++myJobId;
+  }
+  myJobReady.notify_all();
+
+  // The calling thread takes care of the first band
+  blitBand(0);
+
+  std::unique_lock<std::mutex> lock(myMutex);
+  myJobDone.wait(lock, [this] { return myBandsLeft == 0; });
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void NTSCFilter::blitBand(uInt32 index)
+{
+  // Rows are filtered independently of each other, so the result doesn't
+  // depend on how the image is split
+  const int first = myJob.height * index / myJob.bands;
+  const int last  = myJob.height * (index + 1) / myJob.bands;
+
+  (mySIMD ? atari_ntsc_blit_single : atari_ntsc_blit_single_scalar)(
+      &myFilter, myJob.src + first * myJob.width, myJob.width, myJob.width,
+      last - first, reinterpret_cast<uInt8*>(myJob.dest) + first * myJob.pitch,
+      myJob.pitch);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void NTSCFilter::setThreads(uInt32 threads)
+{
+  if(threads == 0)
+    threads = BSPF::clamp(std::thread::hardware_concurrency(), 1u, 4u);
+
+  if(threads != myThreads)
+  {
+    stopWorkers();
+    myThreads = threads;
+  }
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void NTSCFilter::startWorkers()
+{
+  stopWorkers();
+
+  for(uInt32 i = 1; i < myThreads; ++i)
+    myWorkers.emplace_back(&NTSCFilter::workerLoop, this, i, myJobId);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void NTSCFilter::stopWorkers()
+{
+  {
+    std::lock_guard<std::mutex> lock(myMutex);
+    myQuit = true;
+  }
+  myJobReady.notify_all();
+
+  for(auto& worker: myWorkers)
+    worker.join();
+  myWorkers.clear();
+  myQuit = false;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void NTSCFilter::workerLoop(uInt32 index, uInt32 jobId)
+{
+  for(;;)
+  {
+    {
+      std::unique_lock<std::mutex> lock(myMutex);
+      myJobReady.wait(lock, [&] { return myQuit || myJobId != jobId; });
+      if(myQuit)
+        return;
+
+      jobId = myJobId;
+      if(index >= myJob.bands)
+        continue;
+    }
+
+    blitBand(index);
+
+    bool done;
+    {
+      std::lock_guard<std::mutex> lock(myMutex);
+      done = --myBandsLeft == 0;
+    }
+    if(done)
+      myJobDone.notify_one();
+  }
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
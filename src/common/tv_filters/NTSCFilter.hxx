@@ -18,9 +18,12 @@
 #ifndef NTSC_FILTER_HXX
 #define NTSC_FILTER_HXX
 
-class TIASurface;
 class Settings;
 
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 #include "bspf.hxx"
 #include "atari_ntsc.hxx"
 
@@ -40,6 +43,7 @@ class NTSCFilter
 {
   public:
     NTSCFilter();
+    ~NTSCFilter();
 
   public:
     // Set one of the available preset adjustments (Composite, S-Video, RGB, etc)
@@ -64,7 +68,7 @@ class NTSCFilter
        uses this as a baseline for calculating its own internal palette
        in YIQ format.
     */
-    void setTIAPalette(const TIASurface& tiaSurface, const uInt32* palette);
+    void setTIAPalette(const uInt32* palette);
 
     // The following are meant to be used strictly for toggling from the GUI
     string setPreset(Preset preset);
@@ -108,25 +112,35 @@ class NTSCFilter
     // output buffer
     // In the current implementation, the source pitch is always the
     // same as the actual width
-    inline void blit_single(uInt8* src_buf, int src_width, int src_height,
-                            uInt32* dest_buf, long dest_pitch)
-    {
-      atari_ntsc_blit_single(&myFilter, src_buf, src_width, src_width, src_height,
-                             dest_buf, dest_pitch);
-    }
-    inline void blit_double(uInt8* src_buf, uInt8* src_back_buf,
-                            int src_width, int src_height,
-                            uInt32* dest_buf, long dest_pitch)
-    {
-      atari_ntsc_blit_double(&myFilter, src_buf, src_back_buf, src_width, src_width,
-                             src_height, dest_buf, dest_pitch);
-    }
+    // Large enough images are split into bands of rows, which are
+    // filtered in parallel by the worker threads (see setThreads())
+    void blit_single(uInt8* src_buf, int src_width, int src_height,
+                     uInt32* dest_buf, long dest_pitch);
+
+    // Set the number of threads used for filtering, including the calling
+    // thread; 0 picks a number based on the available cores
+    void setThreads(uInt32 threads);
+
+    // Use the SIMD version of the filter for the current CPU (the default),
+    // or the portable one; both generate the same output
+    void enableSIMD(bool enable) { mySIMD = enable; }
 
   private:
     // Convert from atari_ntsc_setup_t values to equivalent adjustables
     void convertToAdjustable(Adjustable& adjustable,
                              const atari_ntsc_setup_t& setup) const;
 
+    // Start/stop the worker threads, according to myThreads
+    void startWorkers();
+    void stopWorkers();
+
+    // Main loop of worker thread 'index' (1 .. number of workers), which
+    // waits for jobs newer than 'jobId'
+    void workerLoop(uInt32 index, uInt32 jobId);
+
+    // Filter band 'index' of the current blit job
+    void blitBand(uInt32 index);
+
   private:
     // The NTSC filter structure
     atari_ntsc_t myFilter;
@@ -142,16 +156,8 @@ class NTSCFilter
     // Current preset in use
     Preset myPreset;
 
-    // The base 2600 palette contains 128 colours
-    // However, 'phosphor' mode needs a 128x128 matrix to simulate
-    // low-flicker output, so we need 128x128 + 128, or 129x128
-    // Note that this is a huge hack, which hopefully will go
-    // away once the phosphor effect can be more properly emulated
-    // Memory layout is as follows:
-    //
-    //    128x128 in first bytes of array
-    //    128     in last bytes of array
-    //    Each colour is represented by 3 bytes, in R,G,B order
+    // The base 2600 palette contains 128 colours, each represented by
+    // 3 bytes, in R,G,B order
     uInt8 myTIAPalette[atari_ntsc_palette_size * 3];
 
     struct AdjustableTag {
@@ -161,6 +167,34 @@ class NTSCFilter
     uInt32 myCurrentAdjustable;
     static const AdjustableTag ourCustomAdjustables[10];
 
+    // Bands are never smaller than this, so that small updates aren't
+    // slowed down by the overhead of waking up the workers
+    static constexpr int kMinBandHeight = 32;
+
+    // Number of threads to use (including the calling thread), and the
+    // worker threads currently running
+    uInt32 myThreads;
+    vector<std::thread> myWorkers;
+
+    // Whether to use the SIMD or portable version of the filter
+    bool mySIMD;
+
+    // The blit currently being done; each thread filters its own band,
+    // and the calling thread waits until all workers are done
+    struct BlitJob {
+      uInt8* src;
+      int width, height;
+      uInt32* dest;
+      long pitch;
+      uInt32 bands;
+    };
+    BlitJob myJob;
+    uInt32 myJobId;       // Incremented for each job, to wake the workers
+    uInt32 myBandsLeft;   // Bands not yet finished by the workers
+    bool myQuit;          // Tells the workers to exit
+    std::mutex myMutex;
+    std::condition_variable myJobReady, myJobDone;
+
   private:
     // Following constructors and assignment operators not supported
     NTSCFilter(const NTSCFilter&) = delete;
@@ -15,8 +15,24 @@
 // this file, and for a DISCLAIMER OF ALL WARRANTIES.
 //============================================================================
 
+#include <cstring>
+
 #include "atari_ntsc.hxx"
 
+#if defined(__SSE2__)
+  #define ATARI_NTSC_SSE2
+  #include <emmintrin.h>
+#elif defined(__ARM_NEON)
+  #define ATARI_NTSC_NEON
+  #include <arm_neon.h>
+#endif
+
+#if (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+  #define ATARI_NTSC_AVX2
+  #include <immintrin.h>
+#endif
+
 /* Copyright (C) 2006-2009 Shay Green. This module is free software; you
    can redistribute it and/or modify it under the terms of the GNU Lesser
    General Public License as published by the Free Software Foundation; either
@@ -66,6 +82,41 @@ static void correct_errors( atari_ntsc_rgb_t color, atari_ntsc_rgb_t* out )
   }
 }
 
+/* The output of a chunk (ATARI_NTSC_RGB_OUT_8888) is the sum of entries from
+   the kernels of five input pixels: the two new pixels of the chunk (cur0 and
+   cur1), the two of the previous chunk (prev0 and prev1) and the second one of
+   the chunk before (prevprev1). For the SIMD blitters, the entries each of
+   these contributes to the 7 output pixels are stored together in one vector,
+   so a whole chunk only takes five vector loads. Missing terms are zero, and
+   since only additions and bit operations are done on the sums, the low 32 bits
+   (which contain the result) are the same as with the scalar code. */
+enum { simd_cur0, simd_cur1, simd_prev0, simd_prev1, simd_prevprev1 };
+
+static void gen_simd_kernel( atari_ntsc_rgb_t const* kernel,
+                             atari_ntsc_out_t out [atari_ntsc_simd_terms] [8] )
+{
+  int i;
+  memset( out, 0, sizeof(atari_ntsc_out_t) * atari_ntsc_simd_terms * 8 );
+  for ( i = 0; i < 7; i++ )
+  {
+    atari_ntsc_out_t const k1  = atari_ntsc_out_t(kernel [(i+10)%7+14]);
+    atari_ntsc_out_t const kx1 = atari_ntsc_out_t(kernel [(i+ 3)%7+14+7]);
+
+    out [simd_cur0 ] [i] = atari_ntsc_out_t(kernel [i]);
+    out [simd_prev0] [i] = atari_ntsc_out_t(kernel [i+7]);
+    if ( i < 4 )
+    {
+      out [simd_prev1    ] [i] = k1;
+      out [simd_prevprev1] [i] = kx1;
+    }
+    else
+    {
+      out [simd_cur1 ] [i] = k1;
+      out [simd_prev1] [i] = kx1;
+    }
+  }
+}
+
 void atari_ntsc_init( atari_ntsc_t* ntsc, atari_ntsc_setup_t const* setup,
                       atari_ntsc_in_t const* palette )
 {
@@ -93,16 +144,18 @@ void atari_ntsc_init( atari_ntsc_t* ntsc, atari_ntsc_setup_t const* setup,
       atari_ntsc_rgb_t* kernel = ntsc->table [entry];
       gen_kernel( &impl, y, i, q, kernel );
       correct_errors( rgb, kernel );
+      gen_simd_kernel( kernel, ntsc->simd [entry] );
     }
   }
 }
 
-void atari_ntsc_blit_single( atari_ntsc_t const* ntsc,
+#define TO_SINGLE(pixel) (pixel>>1)
+
+void atari_ntsc_blit_single_scalar( atari_ntsc_t const* ntsc,
     atari_ntsc_in_t const* atari_in,
     long in_row_width, int in_width, int in_height,
     void* rgb_out, long out_pitch )
 {
-  #define TO_SINGLE(pixel) ((1<<14)+(pixel>>1))
 
   int const chunk_count = (in_width - 1) / atari_ntsc_in_chunk;
   while ( in_height-- )
@@ -148,63 +201,218 @@ void atari_ntsc_blit_single( atari_ntsc_t const* ntsc,
   }
 }
 
-void atari_ntsc_blit_double( atari_ntsc_t const* ntsc,
-    atari_ntsc_in_t const* atari_in1, atari_ntsc_in_t const* atari_in2,
-    long in_row_width, int in_width, int in_height,
-    void* rgb_out, long out_pitch )
+/* The SIMD blitters filter one row at a time, keeping track of the input
+   pixels of the previous chunks. All chunks but the last write 8 pixels, the
+   last of which is overwritten by the next chunk. */
+typedef void (*atari_ntsc_row_blitter_t)( atari_ntsc_t const* ntsc,
+    atari_ntsc_in_t const* in, int chunk_count, atari_ntsc_out_t* out );
+
+#if defined(ATARI_NTSC_SSE2)
+static inline __m128i clamp_sse2( __m128i raw )
 {
-  #define TO_DOUBLE(pixel1, pixel2) (((pixel1>>1)<<7)+(pixel2>>1))
+  __m128i const sub = _mm_and_si128( _mm_srli_epi32( raw, 9 ),
+      _mm_set1_epi32( int(atari_ntsc_clamp_mask) ) );
+  __m128i clamp = _mm_sub_epi32( _mm_set1_epi32( int(atari_ntsc_clamp_add) ), sub );
+  raw = _mm_or_si128( raw, clamp );
+  clamp = _mm_sub_epi32( clamp, sub );
+  raw = _mm_and_si128( raw, clamp );
 
-  int const chunk_count = (in_width - 1) / atari_ntsc_in_chunk;
-  while ( in_height-- )
+  return _mm_or_si128( _mm_or_si128(
+      _mm_and_si128( _mm_srli_epi32( raw, 5 ), _mm_set1_epi32( 0x00FF0000 ) ),
+      _mm_and_si128( _mm_srli_epi32( raw, 3 ), _mm_set1_epi32( 0x0000FF00 ) ) ),
+      _mm_and_si128( _mm_srli_epi32( raw, 1 ), _mm_set1_epi32( 0x000000FF ) ) );
+}
+
+static inline __m128i sum_sse2( atari_ntsc_t const* ntsc, unsigned cur0,
+    unsigned cur1, unsigned prev0, unsigned prev1, unsigned prevprev1, int half )
+{
+  #define LOAD_( color, term ) _mm_loadu_si128( reinterpret_cast<__m128i const*>( \
+      &ntsc->simd [color] [term] [half * 4] ) )
+  __m128i const raw = _mm_add_epi32(
+      _mm_add_epi32( LOAD_( cur0, simd_cur0 ), LOAD_( cur1, simd_cur1 ) ),
+      _mm_add_epi32( _mm_add_epi32( LOAD_( prev0, simd_prev0 ), LOAD_( prev1, simd_prev1 ) ),
+                     LOAD_( prevprev1, simd_prevprev1 ) ) );
+  #undef LOAD_
+  return clamp_sse2( raw );
+}
+
+static void blit_row_sse2( atari_ntsc_t const* ntsc,
+    atari_ntsc_in_t const* in, int chunk_count, atari_ntsc_out_t* out )
+{
+  unsigned prev0 = TO_SINGLE(atari_ntsc_black), prev1 = TO_SINGLE(in [0]);
+  unsigned prevprev1 = TO_SINGLE(atari_ntsc_black);
+  atari_ntsc_out_t last [4];
+  ++in;
+
+  for ( ; chunk_count; --chunk_count )
   {
-    atari_ntsc_in_t const* line_in1 = atari_in1;
-    atari_ntsc_in_t const* line_in2 = atari_in2;
-    ATARI_NTSC_BEGIN_ROW( ntsc,
-        TO_DOUBLE(atari_ntsc_black, atari_ntsc_black),
-        TO_DOUBLE(line_in1[0], line_in2[0]) );
-    atari_ntsc_out_t* restrict line_out = static_cast<atari_ntsc_out_t*>(rgb_out);
-    int n;
-    ++line_in1;
-    ++line_in2;
+    unsigned const cur0 = TO_SINGLE(in [0]), cur1 = TO_SINGLE(in [1]);
+    _mm_storeu_si128( reinterpret_cast<__m128i*>( out ),
+        sum_sse2( ntsc, cur0, cur1, prev0, prev1, prevprev1, 0 ) );
+    _mm_storeu_si128( reinterpret_cast<__m128i*>( out + 4 ),
+        sum_sse2( ntsc, cur0, cur1, prev0, prev1, prevprev1, 1 ) );
+    prevprev1 = prev1;
+    prev0 = cur0;
+    prev1 = cur1;
+    in  += 2;
+    out += 7;
+  }
 
-    for ( n = chunk_count; n; --n )
-    {
-      /* order of input and output pixels must not be altered */
-      ATARI_NTSC_COLOR_IN( 0, ntsc,
-          TO_DOUBLE(line_in1[0], line_in2[0]) );
-      ATARI_NTSC_RGB_OUT_8888( 0, line_out[0] );
-      ATARI_NTSC_RGB_OUT_8888( 1, line_out[1] );
-      ATARI_NTSC_RGB_OUT_8888( 2, line_out[2] );
-      ATARI_NTSC_RGB_OUT_8888( 3, line_out[3] );
+  /* finish final pixels */
+  unsigned const black = TO_SINGLE(atari_ntsc_black);
+  _mm_storeu_si128( reinterpret_cast<__m128i*>( out ),
+      sum_sse2( ntsc, black, black, prev0, prev1, prevprev1, 0 ) );
+  _mm_storeu_si128( reinterpret_cast<__m128i*>( last ),
+      sum_sse2( ntsc, black, black, prev0, prev1, prevprev1, 1 ) );
+  memcpy( out + 4, last, 3 * sizeof(atari_ntsc_out_t) );
+}
+#endif
 
-      ATARI_NTSC_COLOR_IN( 1, ntsc,
-          TO_DOUBLE(line_in1[1], line_in2[1]) );
-      ATARI_NTSC_RGB_OUT_8888( 4, line_out[4] );
-      ATARI_NTSC_RGB_OUT_8888( 5, line_out[5] );
-      ATARI_NTSC_RGB_OUT_8888( 6, line_out[6] );
+#if defined(ATARI_NTSC_AVX2)
+/* Compiled for AVX2 regardless of the build flags; only used after the CPU
+   has been checked for support */
+__attribute__((target("avx2")))
+static inline __m256i sum_avx2( atari_ntsc_t const* ntsc, unsigned cur0,
+    unsigned cur1, unsigned prev0, unsigned prev1, unsigned prevprev1 )
+{
+  #define LOAD_( color, term ) _mm256_loadu_si256( reinterpret_cast<__m256i const*>( \
+      ntsc->simd [color] [term] ) )
+  __m256i raw = _mm256_add_epi32(
+      _mm256_add_epi32( LOAD_( cur0, simd_cur0 ), LOAD_( cur1, simd_cur1 ) ),
+      _mm256_add_epi32( _mm256_add_epi32( LOAD_( prev0, simd_prev0 ), LOAD_( prev1, simd_prev1 ) ),
+                        LOAD_( prevprev1, simd_prevprev1 ) ) );
+  #undef LOAD_
 
-      line_in1 += 2;
-      line_in2 += 2;
-      line_out += 7;
-    }
+  __m256i const sub = _mm256_and_si256( _mm256_srli_epi32( raw, 9 ),
+      _mm256_set1_epi32( int(atari_ntsc_clamp_mask) ) );
+  __m256i clamp = _mm256_sub_epi32( _mm256_set1_epi32( int(atari_ntsc_clamp_add) ), sub );
+  raw = _mm256_or_si256( raw, clamp );
+  clamp = _mm256_sub_epi32( clamp, sub );
+  raw = _mm256_and_si256( raw, clamp );
 
-    /* finish final pixels */
-    ATARI_NTSC_COLOR_IN( 0, ntsc,
-        TO_DOUBLE(atari_ntsc_black, atari_ntsc_black) );
-    ATARI_NTSC_RGB_OUT_8888( 0, line_out[0] );
-    ATARI_NTSC_RGB_OUT_8888( 1, line_out[1] );
-    ATARI_NTSC_RGB_OUT_8888( 2, line_out[2] );
-    ATARI_NTSC_RGB_OUT_8888( 3, line_out[3] );
+  return _mm256_or_si256( _mm256_or_si256(
+      _mm256_and_si256( _mm256_srli_epi32( raw, 5 ), _mm256_set1_epi32( 0x00FF0000 ) ),
+      _mm256_and_si256( _mm256_srli_epi32( raw, 3 ), _mm256_set1_epi32( 0x0000FF00 ) ) ),
+      _mm256_and_si256( _mm256_srli_epi32( raw, 1 ), _mm256_set1_epi32( 0x000000FF ) ) );
+}
 
-    ATARI_NTSC_COLOR_IN( 1, ntsc,
-        TO_DOUBLE(atari_ntsc_black, atari_ntsc_black) );
-    ATARI_NTSC_RGB_OUT_8888( 4, line_out[4] );
-    ATARI_NTSC_RGB_OUT_8888( 5, line_out[5] );
-    ATARI_NTSC_RGB_OUT_8888( 6, line_out[6] );
+__attribute__((target("avx2")))
+static void blit_row_avx2( atari_ntsc_t const* ntsc,
+    atari_ntsc_in_t const* in, int chunk_count, atari_ntsc_out_t* out )
+{
+  unsigned prev0 = TO_SINGLE(atari_ntsc_black), prev1 = TO_SINGLE(in [0]);
+  unsigned prevprev1 = TO_SINGLE(atari_ntsc_black);
+  atari_ntsc_out_t last [8];
+  ++in;
+
+  for ( ; chunk_count; --chunk_count )
+  {
+    unsigned const cur0 = TO_SINGLE(in [0]), cur1 = TO_SINGLE(in [1]);
+    _mm256_storeu_si256( reinterpret_cast<__m256i*>( out ),
+        sum_avx2( ntsc, cur0, cur1, prev0, prev1, prevprev1 ) );
+    prevprev1 = prev1;
+    prev0 = cur0;
+    prev1 = cur1;
+    in  += 2;
+    out += 7;
+  }
+
+  /* finish final pixels */
+  unsigned const black = TO_SINGLE(atari_ntsc_black);
+  _mm256_storeu_si256( reinterpret_cast<__m256i*>( last ),
+      sum_avx2( ntsc, black, black, prev0, prev1, prevprev1 ) );
+  memcpy( out, last, 7 * sizeof(atari_ntsc_out_t) );
+}
+
+static bool have_avx2()
+{
+  __builtin_cpu_init();
+  return __builtin_cpu_supports( "avx2" );
+}
+#endif
+
+#if defined(ATARI_NTSC_NEON)
+static inline uint32x4_t sum_neon( atari_ntsc_t const* ntsc, unsigned cur0,
+    unsigned cur1, unsigned prev0, unsigned prev1, unsigned prevprev1, int half )
+{
+  #define LOAD_( color, term ) vld1q_u32( &ntsc->simd [color] [term] [half * 4] )
+  uint32x4_t raw = vaddq_u32(
+      vaddq_u32( LOAD_( cur0, simd_cur0 ), LOAD_( cur1, simd_cur1 ) ),
+      vaddq_u32( vaddq_u32( LOAD_( prev0, simd_prev0 ), LOAD_( prev1, simd_prev1 ) ),
+                 LOAD_( prevprev1, simd_prevprev1 ) ) );
+  #undef LOAD_
+
+  uint32x4_t const sub = vandq_u32( vshrq_n_u32( raw, 9 ),
+      vdupq_n_u32( atari_ntsc_out_t(atari_ntsc_clamp_mask) ) );
+  uint32x4_t clamp = vsubq_u32( vdupq_n_u32( atari_ntsc_out_t(atari_ntsc_clamp_add) ), sub );
+  raw = vorrq_u32( raw, clamp );
+  clamp = vsubq_u32( clamp, sub );
+  raw = vandq_u32( raw, clamp );
 
-    atari_in1 += in_row_width;
-    atari_in2 += in_row_width;
+  return vorrq_u32( vorrq_u32(
+      vandq_u32( vshrq_n_u32( raw, 5 ), vdupq_n_u32( 0x00FF0000 ) ),
+      vandq_u32( vshrq_n_u32( raw, 3 ), vdupq_n_u32( 0x0000FF00 ) ) ),
+      vandq_u32( vshrq_n_u32( raw, 1 ), vdupq_n_u32( 0x000000FF ) ) );
+}
+
+static void blit_row_neon( atari_ntsc_t const* ntsc,
+    atari_ntsc_in_t const* in, int chunk_count, atari_ntsc_out_t* out )
+{
+  unsigned prev0 = TO_SINGLE(atari_ntsc_black), prev1 = TO_SINGLE(in [0]);
+  unsigned prevprev1 = TO_SINGLE(atari_ntsc_black);
+  atari_ntsc_out_t last [4];
+  ++in;
+
+  for ( ; chunk_count; --chunk_count )
+  {
+    unsigned const cur0 = TO_SINGLE(in [0]), cur1 = TO_SINGLE(in [1]);
+    vst1q_u32( out,     sum_neon( ntsc, cur0, cur1, prev0, prev1, prevprev1, 0 ) );
+    vst1q_u32( out + 4, sum_neon( ntsc, cur0, cur1, prev0, prev1, prevprev1, 1 ) );
+    prevprev1 = prev1;
+    prev0 = cur0;
+    prev1 = cur1;
+    in  += 2;
+    out += 7;
+  }
+
+  /* finish final pixels */
+  unsigned const black = TO_SINGLE(atari_ntsc_black);
+  vst1q_u32( out,  sum_neon( ntsc, black, black, prev0, prev1, prevprev1, 0 ) );
+  vst1q_u32( last, sum_neon( ntsc, black, black, prev0, prev1, prevprev1, 1 ) );
+  memcpy( out + 4, last, 3 * sizeof(atari_ntsc_out_t) );
+}
+#endif
+
+void atari_ntsc_blit_single( atari_ntsc_t const* ntsc,
+    atari_ntsc_in_t const* atari_in,
+    long in_row_width, int in_width, int in_height,
+    void* rgb_out, long out_pitch )
+{
+  atari_ntsc_row_blitter_t blit_row = 0;
+#if defined(ATARI_NTSC_AVX2)
+  static bool const avx2 = have_avx2();
+  if ( avx2 )
+    blit_row = blit_row_avx2;
+#endif
+#if defined(ATARI_NTSC_SSE2)
+  if ( !blit_row )
+    blit_row = blit_row_sse2;
+#elif defined(ATARI_NTSC_NEON)
+  blit_row = blit_row_neon;
+#endif
+
+  if ( !blit_row )
+  {
+    atari_ntsc_blit_single_scalar( ntsc, atari_in, in_row_width, in_width,
+                                   in_height, rgb_out, out_pitch );
+    return;
+  }
+
+  int const chunk_count = (in_width - 1) / atari_ntsc_in_chunk;
+  while ( in_height-- )
+  {
+    blit_row( ntsc, atari_in, chunk_count, static_cast<atari_ntsc_out_t*>(rgb_out) );
+    atari_in += in_row_width;
     rgb_out = static_cast<char*>(rgb_out) + out_pitch;
   }
 }
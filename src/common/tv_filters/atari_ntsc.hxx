@@ -53,7 +53,7 @@ extern atari_ntsc_setup_t const atari_ntsc_svideo;    /* color bleeding only */
 extern atari_ntsc_setup_t const atari_ntsc_rgb;       /* crisp image */
 extern atari_ntsc_setup_t const atari_ntsc_bad;       /* badly adjusted TV */
 
-enum { atari_ntsc_palette_size = 129 * 128 };
+enum { atari_ntsc_palette_size = 128 };
 
 /* Initializes and adjusts parameters. Can be called multiple times on the same
    atari_ntsc_t object. Can pass NULL for either parameter. */
@@ -68,8 +68,12 @@ void atari_ntsc_blit_single( atari_ntsc_t const* ntsc,
     atari_ntsc_in_t const* atari_in,
     long in_row_width, int in_width, int in_height,
     void* rgb_out, long out_pitch );
-void atari_ntsc_blit_double( atari_ntsc_t const* ntsc,
-    atari_ntsc_in_t const* atari_in1, atari_ntsc_in_t const* atari_in2,
+
+/* Same as atari_ntsc_blit_single(), but always uses the portable code, rather
+   than the SIMD version selected for the current CPU. The output is identical;
+   this is mainly useful for testing and benchmarking. */
+void atari_ntsc_blit_single_scalar( atari_ntsc_t const* ntsc,
+    atari_ntsc_in_t const* atari_in,
     long in_row_width, int in_width, int in_height,
     void* rgb_out, long out_pitch );
 
@@ -117,8 +121,11 @@ enum { atari_ntsc_black     = 0  }; /* palette index for black */
 /* private */
 enum { atari_ntsc_entry_size = 2 * 14 };
 typedef unsigned long atari_ntsc_rgb_t;
+enum { atari_ntsc_simd_terms = 5 };
 struct atari_ntsc_t {
 	atari_ntsc_rgb_t table [atari_ntsc_palette_size] [atari_ntsc_entry_size];
+	/* kernel entries regrouped for the SIMD blitters (see atari_ntsc.cxx) */
+	atari_ntsc_out_t simd [atari_ntsc_palette_size] [atari_ntsc_simd_terms] [8];
 };
 
 #define ATARI_NTSC_ENTRY_( ntsc, n ) (ntsc)->table [n]
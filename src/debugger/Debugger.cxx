@@ -114,7 +114,10 @@ Debugger::Debugger(OSystem& osystem, Console& console)
     mySystem(console.system()),
     myDialog(nullptr),
     myWidth(DebuggerDialog::kSmallFontMinW),
-    myHeight(DebuggerDialog::kSmallFontMinH)
+    myHeight(DebuggerDialog::kSmallFontMinH),
+    myMainThread(std::this_thread::get_id()),
+    myStartDeferred(false),
+    myDeferredFatal(false)
 {
   // Init parser
   myParser = make_ptr<DebuggerParser>(*this, osystem.settings());
@@ -166,15 +169,23 @@ FBInitStatus Debugger::initializeVideo()
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 bool Debugger::start(const string& message, int address)
 {
+  ostringstream buf;
+  buf << message;
+  if(address > -1)
+    buf << Common::Base::HEX4 << address;
+
+  if(std::this_thread::get_id() != myMainThread)
+  {
+    myStartDeferred = true;
+    myDeferredFatal = false;
+    myDeferredMessage = buf.str();
+    return true;
+  }
+
   if(myOSystem.eventHandler().enterDebugMode())
   {
     // This must be done *after* we enter debug mode,
     // so the message isn't erased
-    ostringstream buf;
-    buf << message;
-    if(address > -1)
-      buf << Common::Base::HEX4 << address;
-
     myDialog->message().setText(buf.str());
     return true;
   }
@@ -184,6 +195,14 @@ bool Debugger::start(const string& message, int address)
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 bool Debugger::startWithFatalError(const string& message)
 {
+  if(std::this_thread::get_id() != myMainThread)
+  {
+    myStartDeferred = true;
+    myDeferredFatal = true;
+    myDeferredMessage = message;
+    return true;
+  }
+
   if(myOSystem.eventHandler().enterDebugMode())
   {
     // This must be done *after* we enter debug mode,
@@ -194,6 +213,17 @@ bool Debugger::startWithFatalError(const string& message)
   return false;
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool Debugger::startDeferred()
+{
+  if(!myStartDeferred)
+    return false;
+
+  myStartDeferred = false;
+  return myDeferredFatal ? startWithFatalError(myDeferredMessage)
+                         : start(myDeferredMessage);
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Debugger::quit(bool exitrom)
 {
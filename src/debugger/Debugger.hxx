@@ -32,6 +32,7 @@ class PromptWidget;
 class ButtonWidget;
 
 #include <map>
+#include <thread>
 
 #include "Base.hxx"
 #include "DialogContainer.hxx"
@@ -92,6 +93,17 @@ class Debugger : public DialogContainer
     bool start(const string& message = "", int address = -1);
     bool startWithFatalError(const string& message = "");
 
+    /**
+      The debugger can only be entered from the main thread.  When start()
+      or startWithFatalError() is called while a frame is emulated on
+      another thread (see 'tia.pipeline'), the call is remembered instead,
+      and this method (called on the main thread once the frame is done)
+      enters the debugger as requested.
+
+      @return  True if the debugger was entered
+    */
+    bool startDeferred();
+
     /**
       Wrapper method for EventHandler::leaveDebugMode() for those classes
       that don't have access to EventHandler.
@@ -295,6 +307,13 @@ class Debugger : public DialogContainer
     uInt32 myWidth;
     uInt32 myHeight;
 
+    // The thread the debugger was created on, and a start() or
+    // startWithFatalError() call from another thread to be done there
+    std::thread::id myMainThread;
+    bool myStartDeferred;
+    bool myDeferredFatal;
+    string myDeferredMessage;
+
     // Class holding all rewind state functionality in the debugger
     // Essentially, it's a modified circular array-based stack
     // that cleverly deals with allocation/deallocation of memory
@@ -69,16 +69,16 @@ void TiaOutputWidget::saveSnapshot()
   FBSurface& s = dialog().surface();
 
   GUI::Rect rect(_x, _y, _x + width*2, _y + height);
-  string message = "Snapshot saved";
   try
   {
-    instance().png().saveImage(sspath.str(), s, rect);
+    // Reported by the EventHandler once written
+    instance().png().saveImage(sspath.str(), s, rect, EmptyVarList,
+                               "Snapshot saved");
   }
   catch(const runtime_error& e)
   {
-    message = e.what();
+    instance().frameBuffer().showMessage(e.what());
   }
-  instance().frameBuffer().showMessage(message);
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
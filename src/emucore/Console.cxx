@@ -461,6 +461,7 @@ FBInitStatus Console::initializeVideo(bool full)
       return fbstatus;
 
     myOSystem.frameBuffer().showFrameStats(myOSystem.settings().getBool("stats"));
+    myOSystem.frameBuffer().enableTurbo(myOSystem.settings().getBool("turbo"));
     generateColorLossPalette();
   }
   setPalette(myOSystem.settings().getString("palette"));
@@ -77,6 +77,9 @@ class Event
       UIUp, UIDown, UILeft, UIRight, UIHome, UIEnd, UIPgUp, UIPgDown,
       UISelect, UINavPrev, UINavNext, UIOK, UICancel, UIPrevDir,
 
+      // New events are added here, so saved mappings keep their values
+      Rewind,
+
       LastType
     };
 
@@ -41,6 +41,7 @@
 #include "Switches.hxx"
 #include "M6532.hxx"
 #include "MouseControl.hxx"
+#include "MovieRecorder.hxx"
 #include "Version.hxx"
 
 #include "EventHandler.hxx"
@@ -116,8 +117,10 @@ void EventHandler::reset(State state)
   // Reset events almost immediately after starting emulation mode
   // We wait a little while, since 'hold' events may be present, and we want
   // time for the ROM to process them
+#ifdef SDL_SUPPORT
   if(state == S_EMULATE)
     SDL_AddTimer(500, resetEventsCallback, static_cast<void*>(this));
+#endif
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -190,22 +193,21 @@ void EventHandler::poll(uInt64 time)
   // Process events from the underlying hardware
   pollEvent();
 
+  // Snapshots are written in the background, so they're reported later
+  string snapMessage;
+  if(myOSystem.png().writeResult(snapMessage))
+    myOSystem.frameBuffer().showMessage(snapMessage);
+
   // Update controllers and console switches, and in general all other things
   // related to emulation
   if(myState == S_EMULATE)
   {
     myOSystem.console().riot().update();
 
-#if 0
     // Now check if the StateManager should be saving or loading state
-    // Per-frame cheats are disabled if the StateManager is active, since
-    // it would interfere with proper playback
     if(myOSystem.state().isActive())
-    {
       myOSystem.state().update();
-    }
-    else
-#endif
+
     {
     #ifdef CHEATCODE_SUPPORT
       for(auto& cheat: myOSystem.cheat().perFrame())
@@ -416,6 +418,14 @@ void EventHandler::handleKeyEvent(StellaKey key, StellaMod mod, bool state)
           myOSystem.frameBuffer().toggleFrameStats();
           break;
 
+        case KBDK_T:  // Alt-t toggles turbo mode
+          myOSystem.frameBuffer().toggleTurbo();
+          break;
+
+        case KBDK_R:  // Alt-r toggles video/sound recording
+          toggleRecording();
+          break;
+
         case KBDK_S:
           if(myContSnapshotInterval == 0)
           {
@@ -878,6 +888,12 @@ void EventHandler::handleEvent(Event::Type event, int state)
       if(myUseCtrlKeyFlag) myFryingFlag = bool(state);
       return;
 
+    case Event::Rewind:
+      // Rewind while the key is held down
+      if(bool(state) != myOSystem.state().isRewinding())
+        myOSystem.state().toggleRewindMode();
+      return;
+
     case Event::VolumeDecrease:
       if(state) myOSystem.sound().adjustVolume(-1);
       return;
@@ -1261,8 +1277,11 @@ void EventHandler::setKeymap()
   Event::Type event;
 
   // Get event count, which should be the first int in the list
+  // Mappings saved before the Rewind event existed are still valid
   buf >> value;
   event = Event::Type(value);
+  if(event == Event::Rewind)
+    event = Event::LastType;
   if(event == Event::LastType)
     while(buf >> value)
       map.push_back(value);
@@ -1539,6 +1558,7 @@ void EventHandler::setDefaultKeymap(Event::Type event, EventMode mode)
       setDefaultKey( KBDK_F11,       Event::LoadState         );
       setDefaultKey( KBDK_F12,       Event::TakeSnapshot      );
       setDefaultKey( KBDK_BACKSPACE, Event::Fry               );
+      setDefaultKey( KBDK_HOME,      Event::Rewind            );
       setDefaultKey( KBDK_PAUSE,     Event::PauseMode         );
       setDefaultKey( KBDK_TAB,       Event::MenuMode          );
       setDefaultKey( KBDK_BACKSLASH, Event::CmdMenuMode       );
@@ -1829,43 +1849,65 @@ void EventHandler::takeSnapshot(uInt32 number)
   VarList::push_back(comments, "TV Effects", myOSystem.frameBuffer().tiaSurface().effectsInfo());
 
   // Now create a PNG snapshot
-  if(myOSystem.settings().getBool("ss1x"))
+  // The message is shown once the snapshot has actually been written
+  const string saved = showmessage ? "Snapshot saved" : "";
+  try
   {
-    string message = "Snapshot saved";
-    try
+    if(myOSystem.settings().getBool("ss1x"))
     {
       GUI::Rect rect;
       const FBSurface& surface = myOSystem.frameBuffer().tiaSurface().baseSurface(rect);
-      myOSystem.png().saveImage(filename, surface, rect, comments);
+      myOSystem.png().saveImage(filename, surface, rect, comments, saved);
     }
-    catch(const runtime_error& e)
+    else
     {
-      message = e.what();
+      // Only the TIA image is copied here (so there are no onscreen messages
+      // in it); it's scaled to the size shown by the writer thread
+      TIASurface::Image image;
+      myOSystem.frameBuffer().tiaSurface().captureImage(image);
+      myOSystem.png().saveImage(filename, image, comments, saved);
     }
+  }
+  catch(const runtime_error& e)
+  {
     if(showmessage)
-      myOSystem.frameBuffer().showMessage(message);
+      myOSystem.frameBuffer().showMessage(e.what());
   }
-  else
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void EventHandler::toggleRecording()
+{
+  MovieRecorder& recorder = myOSystem.recorder();
+  if(recorder.isRecording())
   {
-    // Make sure we have a 'clean' image, with no onscreen messages
-    myOSystem.frameBuffer().enableMessages(false);
-    myOSystem.frameBuffer().tiaSurface().render();
+    myOSystem.frameBuffer().showMessage(recorder.stop());
+    return;
+  }
 
-    string message = "Snapshot saved";
-    try
-    {
-      myOSystem.png().saveImage(filename, comments);
-    }
-    catch(const runtime_error& e)
-    {
-      message = e.what();
-    }
+  // Recordings are named like snapshots, never overwriting an earlier one
+  const string& path = myOSystem.snapshotSaveDir() +
+      (myOSystem.settings().getString("snapname") != "int" ?
+          myOSystem.romFile().getNameWithExt("")
+        : myOSystem.console().properties().get(Cartridge_Name));
+  string basename = path;
+  for(uInt32 i = 1; FilesystemNode(basename + ".y4m").exists(); ++i)
+  {
+    ostringstream buf;
+    buf << path << "_" << i;
+    basename = buf.str();
+  }
 
-    // Re-enable old messages
-    myOSystem.frameBuffer().enableMessages(true);
-    if(showmessage)
-      myOSystem.frameBuffer().showMessage(message);
+  string message = "Recording started";
+  try
+  {
+    recorder.start(basename);
+  }
+  catch(const runtime_error& e)
+  {
+    message = e.what();
   }
+  myOSystem.frameBuffer().showMessage(message);
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -1932,7 +1974,6 @@ void EventHandler::enterMenuMode(State state)
 void EventHandler::leaveMenuMode()
 {
   setEventState(S_EMULATE);
-  myOSystem.sound().mute(false);
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -1982,7 +2023,7 @@ void EventHandler::leaveDebugMode()
 
   setEventState(S_EMULATE);
   myOSystem.createFrameBuffer();
-  myOSystem.sound().mute(false);
+  myOSystem.sound().mute(myOSystem.frameBuffer().turboEnabled());
 #endif
 }
 
@@ -1991,6 +2032,10 @@ void EventHandler::setEventState(State state)
 {
   myState = state;
 
+  // The rewind key may be released in another state, and never seen
+  if(myOSystem.state().isRewinding())
+    myOSystem.state().toggleRewindMode();
+
   // Normally, the usage of Control key is determined by 'ctrlcombo'
   // For certain ROMs it may be forced off, whatever the setting
   myUseCtrlKeyFlag = myOSystem.settings().getBool("ctrlcombo");
@@ -2001,7 +2046,7 @@ void EventHandler::setEventState(State state)
   {
     case S_EMULATE:
       myOverlay = nullptr;
-      myOSystem.sound().mute(false);
+      myOSystem.sound().mute(myOSystem.frameBuffer().turboEnabled());
       enableTextEvents(false);
       if(myOSystem.console().leftController().type() == Controller::CompuMate)
         myUseCtrlKeyFlag = false;
@@ -2080,6 +2125,7 @@ EventHandler::ActionList EventHandler::ourEmulActionList[kEmulActionListSize] =
   { Event::LoadState,              "Load State",               "", false },
   { Event::TakeSnapshot,           "Snapshot",                 "", false },
   { Event::Fry,                    "Fry cartridge",            "", false },
+  { Event::Rewind,                 "Rewind (hold)",            "", false },
   { Event::VolumeDecrease,         "Decrease volume",          "", false },
   { Event::VolumeIncrease,         "Increase volume",          "", false },
   { Event::PauseMode,              "Pause",                    "", false },
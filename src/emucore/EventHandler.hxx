@@ -190,6 +190,12 @@ class EventHandler
     void leaveDebugMode();
     void takeSnapshot(uInt32 number = 0);
 
+    /**
+      Start recording the video and sound to a new file in the snapshot
+      directory, or stop the recording in progress.
+    */
+    void toggleRecording();
+
     /**
       Send an event directly to the event handler.
       These events cannot be remapped.
@@ -501,7 +507,7 @@ class EventHandler
     enum {
       kComboSize          = 16,
       kEventsPerCombo     = 8,
-      kEmulActionListSize = 78 + kComboSize,
+      kEmulActionListSize = 79 + kComboSize,
       kMenuActionListSize = 14
     };
 
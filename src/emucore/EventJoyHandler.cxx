@@ -239,8 +239,10 @@ EventHandler::JoystickHandler::JoystickHandler(OSystem& system)
   string joymap, joyname;
 
   // First check the event type, and disregard the entire mapping if it's invalid
+  // Mappings saved before the Rewind event existed are still valid
   getline(buf, joymap, '^');
-  if(atoi(joymap.c_str()) == Event::LastType)
+  const int count = atoi(joymap.c_str());
+  if(count == Event::LastType || count == Event::Rewind)
   {
     // Otherwise, put each joystick mapping entry into the database
     while(getline(buf, joymap, '^'))
@@ -201,6 +201,40 @@ class FBSurface
     */
     virtual void setDirty() { }
 
+    /**
+      This method should be called to indicate that the surface should be
+      redrawn at the next interval, but only the given rows of its pixels
+      have changed since it was last drawn.  Calls accumulate until the
+      surface is drawn; a height of zero redraws without any changed rows.
+
+      @param y  The first row that changed
+      @param h  The number of rows that changed
+    */
+    virtual void setDirtyRows(uInt32 y, uInt32 h) { setDirty(); }
+
+    /**
+      This method gives access to the given rows of the texture behind the
+      surface, if supported, so they can be written directly rather than
+      through basePtr() and setDirtyRows().  All pixels of these rows must
+      be written, since their previous contents are undefined, and the rows
+      must be released with unlockRows() before the surface is drawn.
+      From then on the pixel buffer is out of date, and is no longer used
+      to draw the surface, until rows are marked as changed again with
+      setDirtyRows().
+
+      @param y       The first row to write
+      @param h       The number of rows to write
+      @param pixels  Set to the first pixel of row 'y'
+      @param pitch   Set to the number of pixels between rows
+      @return  False if the rows can't be accessed directly (for example,
+               right after the texture was recreated)
+    */
+    virtual bool lockRows(uInt32 y, uInt32 h, uInt32*& pixels, uInt32& pitch)
+    {
+      return false;
+    }
+    virtual void unlockRows() { }
+
     //////////////////////////////////////////////////////////////////////////
     // Note:  The following methods are FBSurface-specific, and must be
     //        implemented in child classes.
@@ -31,8 +31,10 @@
 #include "ConsoleFont.hxx"
 #include "Launcher.hxx"
 #include "Menu.hxx"
+#include "MovieRecorder.hxx"
 #include "OSystem.hxx"
 #include "Settings.hxx"
+#include "Sound.hxx"
 #include "TIA.hxx"
 
 #include "FBSurface.hxx"
@@ -46,14 +48,34 @@
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 FrameBuffer::FrameBuffer(OSystem& osystem)
   : myOSystem(osystem),
+    myRGBPalette(nullptr),
     myInitializedCount(0),
     myPausedCount(0),
+    myTurboEnabled(false),
+    myTurboFrames(0),
+    myPipelineEnabled(false),
+    myEmulating(false),
+    myQuitEmulation(false),
     myCurrentModeList(nullptr)
 {
   myMsg.surface = myStatsMsg.surface = nullptr;
   myMsg.enabled = myStatsMsg.enabled = false;
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+FrameBuffer::~FrameBuffer()
+{
+  if(myEmulator.joinable())
+  {
+    {
+      std::lock_guard<std::mutex> lock(myEmulationMutex);
+      myQuitEmulation = true;
+    }
+    myEmulationStart.notify_one();
+    myEmulator.join();
+  }
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 bool FrameBuffer::initialize()
 {
@@ -142,6 +164,7 @@ bool FrameBuffer::initialize()
 
   // Create a TIA surface; we need it for rendering TIA images
   myTIASurface = make_ptr<TIASurface>(myOSystem);
+  myPipelineEnabled = myOSystem.settings().getBool("tia.pipeline");
 
   return true;
 }
@@ -220,7 +243,7 @@ FBInitStatus FrameBuffer::createDisplay(const string& title,
   // Create surfaces for TIA statistics and general messages
   myStatsMsg.color = kBtnTextColor;
   myStatsMsg.w = infoFont().getMaxCharWidth() * 24 + 2;
-  myStatsMsg.h = (infoFont().getFontHeight() + 2) * 2;
+  myStatsMsg.h = (infoFont().getFontHeight() + 2) * 4;
 
   if(!myStatsMsg.surface)
     myStatsMsg.surface = allocateSurface(myStatsMsg.w, myStatsMsg.h);
@@ -255,10 +278,19 @@ void FrameBuffer::update()
   {
     case EventHandler::S_EMULATE:
     {
-      // Run the console for one frame
+      if(myPipelineEnabled && !myTurboEnabled)
+      {
+        updatePipelined();
+        return;
+      }
+
+      // Run the console for one frame (or as many as possible in turbo mode)
       // Note that the debugger can cause a breakpoint to occur, which changes
       // the EventHandler state 'behind our back' - we need to check for that
-      myOSystem.console().tia().update();
+      if(myTurboEnabled)
+        updateTurbo();
+      else
+        myOSystem.console().tia().update();
   #ifdef DEBUGGER_SUPPORT
       if(myOSystem.eventHandler().state() != EventHandler::S_EMULATE) break;
   #endif
@@ -271,18 +303,7 @@ void FrameBuffer::update()
       // Show frame statistics
       if(myStatsMsg.enabled)
       {
-        const ConsoleInfo& info = myOSystem.console().about();
-        char msg[30];
-        std::snprintf(msg, 30, "%3u @ %3.2ffps => %s",
-                myOSystem.console().tia().scanlinesLastFrame(),
-                myOSystem.console().getFramerate(), info.DisplayFormat.c_str());
-        myStatsMsg.surface->fillRect(0, 0, myStatsMsg.w, myStatsMsg.h, kBGColor);
-        myStatsMsg.surface->drawString(infoFont(),
-          msg, 1, 1, myStatsMsg.w, myStatsMsg.color, kTextAlignLeft);
-        myStatsMsg.surface->drawString(infoFont(),
-          info.BankSwitch, 1, 15, myStatsMsg.w, myStatsMsg.color, kTextAlignLeft);
-        myStatsMsg.surface->setDirty();
-        myStatsMsg.surface->setDstPos(myImageRect.x() + 1, myImageRect.y() + 1);
+        drawFrameStats();
         myStatsMsg.surface->render();
       }
       break;  // S_EMULATE
@@ -341,6 +362,109 @@ void FrameBuffer::update()
   postFrameUpdate();
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void FrameBuffer::updatePipelined()
+{
+  // Everything shown is taken from the emulation before the next frame is
+  // started, and the emulation thread is done before we return, so that
+  // events, the GUI and the debugger only ever see the console idle
+  myTIASurface->holdFrame();
+  if(myStatsMsg.enabled)
+    drawFrameStats();
+  startEmulation();
+
+  myTIASurface->render();
+  if(myStatsMsg.enabled)
+    myStatsMsg.surface->render();
+  if(myMsg.enabled)
+    drawMessage();
+  postFrameUpdate();
+
+  finishEmulation();
+
+  // The debugger can't be entered from the emulation thread, so breakpoints
+  // hit there are only handled now
+#ifdef DEBUGGER_SUPPORT
+  if(myOSystem.debugger().startDeferred())
+    return;
+#endif
+  if(myOSystem.eventHandler().frying())
+    myOSystem.console().fry();
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void FrameBuffer::drawFrameStats()
+{
+  const ConsoleInfo& info = myOSystem.console().about();
+  char msg[30];
+  if(myTurboEnabled)
+    std::snprintf(msg, 30, "%3u @ turbo x%u => %s",
+            myOSystem.console().tia().scanlinesLastFrame(),
+            myTurboFrames, info.DisplayFormat.c_str());
+  else
+    std::snprintf(msg, 30, "%3u @ %3.2ffps => %s",
+            myOSystem.console().tia().scanlinesLastFrame(),
+            myOSystem.console().getFramerate(), info.DisplayFormat.c_str());
+  myStatsMsg.surface->fillRect(0, 0, myStatsMsg.w, myStatsMsg.h, kBGColor);
+  myStatsMsg.surface->drawString(infoFont(),
+    msg, 1, 1, myStatsMsg.w, myStatsMsg.color, kTextAlignLeft);
+  myStatsMsg.surface->drawString(infoFont(),
+    info.BankSwitch, 1, 15, myStatsMsg.w, myStatsMsg.color, kTextAlignLeft);
+  std::snprintf(msg, 30, "%u idle cycles",
+          myOSystem.console().tia().idleCyclesLastFrame());
+  myStatsMsg.surface->drawString(infoFont(),
+    msg, 1, 29, myStatsMsg.w, myStatsMsg.color, kTextAlignLeft);
+  const uInt32 latency = std::min(myOSystem.sound().latency(), 9999u);
+  if(latency > 0)
+    std::snprintf(msg, 30, "Sound %ums, %+.2f%%", latency,
+            BSPF::clamp(myOSystem.sound().rateAdjust(), -9.99, 9.99));
+  else
+    std::snprintf(msg, 30, "Sound off");
+  myStatsMsg.surface->drawString(infoFont(),
+    msg, 1, 43, myStatsMsg.w, myStatsMsg.color, kTextAlignLeft);
+  myStatsMsg.surface->setDirty();
+  myStatsMsg.surface->setDstPos(myImageRect.x() + 1, myImageRect.y() + 1);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void FrameBuffer::startEmulation()
+{
+  if(!myEmulator.joinable())
+    myEmulator = std::thread(&FrameBuffer::emulationThread, this);
+
+  {
+    std::lock_guard<std::mutex> lock(myEmulationMutex);
+    myEmulating = true;
+  }
+  myEmulationStart.notify_one();
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void FrameBuffer::finishEmulation()
+{
+  std::unique_lock<std::mutex> lock(myEmulationMutex);
+  myEmulationDone.wait(lock, [this] { return !myEmulating; });
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void FrameBuffer::emulationThread()
+{
+  std::unique_lock<std::mutex> lock(myEmulationMutex);
+  for(;;)
+  {
+    myEmulationStart.wait(lock, [this] { return myEmulating || myQuitEmulation; });
+    if(myQuitEmulation)
+      return;
+
+    lock.unlock();
+    myOSystem.console().tia().update();
+    lock.lock();
+
+    myEmulating = false;
+    myEmulationDone.notify_one();
+  }
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void FrameBuffer::showMessage(const string& message, MessagePosition position,
                               bool force)
@@ -375,6 +499,64 @@ void FrameBuffer::showFrameStats(bool enable)
   myStatsMsg.enabled = enable;
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void FrameBuffer::toggleTurbo()
+{
+  enableTurbo(!myTurboEnabled);
+  showMessage(myTurboEnabled ? "Turbo mode enabled" : "Turbo mode disabled");
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void FrameBuffer::enableTurbo(bool enable)
+{
+  myOSystem.settings().setValue("turbo", enable);
+  myTurboEnabled = enable;
+
+  // Sound can't keep up with turbo mode, so it's muted meanwhile
+  if(myOSystem.eventHandler().state() == EventHandler::S_EMULATE)
+    myOSystem.sound().mute(enable);
+
+  if(!enable && myOSystem.hasConsole())
+    myOSystem.console().tia().enableDrawing(true);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void FrameBuffer::updateTurbo()
+{
+  // Emulate frames without drawing them for the time the frame being shown
+  // would normally take; the last two are drawn, since the TIA surface uses
+  // both the current and the previous frame buffer.  While recording or
+  // streaming, all frames are drawn, since they're all captured.
+  TIA& tia = myOSystem.console().tia();
+  const bool recording = myOSystem.recorder().isCapturing();
+  const uInt64 start = myOSystem.getTicks();
+  const uInt64 end = start + uInt64(1000000 / myOSystem.frameRate());
+
+  myTurboFrames = 0;
+  tia.enableDrawing(recording);
+  for(;;)
+  {
+    const uInt64 now = myOSystem.getTicks();
+    const bool last = myTurboFrames > 0 &&
+                      now + 2 * (now - start) / myTurboFrames >= end;
+
+    tia.enableDrawing(last || recording);
+    tia.update();
+    ++myTurboFrames;
+
+    if(myOSystem.eventHandler().state() != EventHandler::S_EMULATE)
+      break;
+
+    if(last)
+    {
+      tia.update();
+      ++myTurboFrames;
+      break;
+    }
+  }
+  tia.enableDrawing(true);
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void FrameBuffer::enableMessages(bool enable)
 {
@@ -501,6 +683,7 @@ void FrameBuffer::setPalette(const uInt32* raw_palette)
 
     myPalette[i] = mapRGB(r, g, b);
   }
+  myRGBPalette = raw_palette;
 
   // Let the TIA surface know about the new palette
   myTIASurface->setPalette(myPalette, raw_palette);
@@ -18,7 +18,10 @@
 #ifndef FRAMEBUFFER_HXX
 #define FRAMEBUFFER_HXX
 
+#include <condition_variable>
 #include <map>
+#include <mutex>
+#include <thread>
 
 class OSystem;
 class Console;
@@ -140,7 +143,7 @@ class FrameBuffer
       Creates a new Frame Buffer
     */
     FrameBuffer(OSystem& osystem);
-    virtual ~FrameBuffer() = default;
+    virtual ~FrameBuffer();
 
     /**
       Initialize the framebuffer object (set up the underlying hardware)
@@ -186,6 +189,18 @@ class FrameBuffer
     */
     void showFrameStats(bool enable);
 
+    /**
+      Toggles turbo mode, in which the console is run as fast as possible
+      and only the frames that are actually shown are drawn.
+    */
+    void toggleTurbo();
+
+    /**
+      Enables/disables turbo mode (see above).
+    */
+    void enableTurbo(bool enable);
+    bool turboEnabled() const { return myTurboEnabled; }
+
     /**
       Enable/disable any pending messages.  Disabled messages aren't removed
       from the message queue; they're just not redrawn into the framebuffer.
@@ -287,6 +302,11 @@ class FrameBuffer
     */
     void setPalette(const uInt32* raw_palette);
 
+    /**
+      Answers the R/G/B colors of the TIA palette last set by setPalette().
+    */
+    const uInt32* rgbPalette() const { return myRGBPalette; }
+
     /**
       Informs the Framebuffer of a change in EventHandler state.
     */
@@ -401,12 +421,44 @@ class FrameBuffer
     // Color palette for TIA and UI modes
     Uint32 myPalette[256+kNumColors];
 
+    // The R/G/B colors the TIA palette was set from
+    const uInt32* myRGBPalette;
+
   private:
     /**
       Draw pending messages.
     */
     void drawMessage();
 
+    /**
+      Run the console in turbo mode for the duration of one frame.
+    */
+    void updateTurbo();
+
+    /**
+      Show the frame emulated at the last update, while the next frame is
+      emulated on the emulation thread (see 'tia.pipeline').
+    */
+    void updatePipelined();
+
+    /**
+      Draw the frame statistics for the frame emulated last into their
+      surface, without rendering it yet.
+    */
+    void drawFrameStats();
+
+    /**
+      Start emulating a frame on the emulation thread (starting the thread
+      when necessary), and wait until it's done, respectively.
+    */
+    void startEmulation();
+    void finishEmulation();
+
+    /**
+      Main loop of the emulation thread.
+    */
+    void emulationThread();
+
     /**
       Issues a 'free' and 'reload' instruction to all surfaces that the
       framebuffer knows about.
@@ -526,6 +578,21 @@ class FrameBuffer
     Message myMsg;
     Message myStatsMsg;
 
+    // Turbo mode, and the number of frames emulated during the last
+    // frame shown in this mode
+    bool myTurboEnabled;
+    uInt32 myTurboFrames;
+
+    // Frames are shown while the next one is emulated on another thread;
+    // only the main thread ever uses SDL, so it keeps drawing and
+    // presenting the frames
+    bool myPipelineEnabled;
+    std::thread myEmulator;
+    std::mutex myEmulationMutex;
+    std::condition_variable myEmulationStart, myEmulationDone;
+    bool myEmulating;
+    bool myQuitEmulation;
+
     // The list of all available video modes for this framebuffer
     VideoModeList* myCurrentModeList;
     VideoModeList myWindowedModeList;
@@ -45,6 +45,9 @@
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 M6502::M6502(const Settings& settings)
   : myExecutionStatus(0),
+    mySkipIdleLoops(false),
+    myIdleLoopPC(-1),
+    mySkippedCycles(0),
     mySystem(nullptr),
     mySettings(settings),
     A(0), X(0), Y(0), SP(0), IR(0), PC(0),
@@ -92,6 +95,11 @@ void M6502::reset()
   PS(BSPF::containsIgnoreCase(cpurandom, "P") ?
           mySystem->randGenerator().next() : 0x20);
 
+  // Skip over RIOT timer polling loops?
+  mySkipIdleLoops = mySettings.getBool("idleskip");
+  myIdleLoopPC = -1;
+  mySkippedCycles = 0;
+
   // Reset access flag
   myLastAccessWasRead = true;
 
@@ -105,6 +113,7 @@ void M6502::reset()
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+template<bool INSTRUMENTED>
 inline uInt8 M6502::peek(uInt16 address, uInt8 flags)
 {
   ////////////////////////////////////////////////
@@ -118,7 +127,7 @@ inline uInt8 M6502::peek(uInt16 address, uInt8 flags)
   mySystem->incrementCycles(SYSTEM_CYCLES_PER_CPU);
 
 #ifdef DEBUGGER_SUPPORT
-  if(myReadTraps.isInitialized() && myReadTraps.isSet(address))
+  if(INSTRUMENTED && myReadTraps.isInitialized() && myReadTraps.isSet(address))
   {
     myJustHitTrapFlag = true;
     myHitTrapInfo.message = "RTrap: ";
@@ -133,6 +142,7 @@ inline uInt8 M6502::peek(uInt16 address, uInt8 flags)
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+template<bool INSTRUMENTED>
 inline void M6502::poke(uInt16 address, uInt8 value)
 {
   ////////////////////////////////////////////////
@@ -146,7 +156,7 @@ inline void M6502::poke(uInt16 address, uInt8 value)
   mySystem->incrementCycles(SYSTEM_CYCLES_PER_CPU);
 
 #ifdef DEBUGGER_SUPPORT
-  if(myWriteTraps.isInitialized() && myWriteTraps.isSet(address))
+  if(INSTRUMENTED && myWriteTraps.isInitialized() && myWriteTraps.isSet(address))
   {
     myJustHitTrapFlag = true;
     myHitTrapInfo.message = "WTrap: ";
@@ -161,38 +171,65 @@ inline void M6502::poke(uInt16 address, uInt8 value)
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 bool M6502::execute(uInt32 number)
+{
+#ifdef DEBUGGER_SUPPORT
+  // The debugger can only change any of these while we're not executing,
+  // so it's enough to check once here whether any of them are in use
+  // If not, the instructions run just as if the debugger wasn't compiled in
+  const bool instrumented = myJustHitTrapFlag ||
+      myBreakPoints.isInitialized() || myReadTraps.isInitialized() ||
+      myWriteTraps.isInitialized() || !myBreakConds.empty();
+
+  return instrumented ? execute<true>(number) : execute<false>(number);
+#else
+  return execute<false>(number);
+#endif  // DEBUGGER_SUPPORT
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+template<bool INSTRUMENTED>
+bool M6502::execute(uInt32 number)
 {
   // Clear all of the execution status bits except for the fatal error bit
   myExecutionStatus &= FatalErrorBit;
 
+  // Skipping instructions would bypass the debugger checks
+  const bool skipIdle = mySkipIdleLoops && !INSTRUMENTED;
+
   // Loop until execution is stopped or a fatal error occurs
   for(;;)
   {
     for(; !myExecutionStatus && (number != 0); --number)
     {
 #ifdef DEBUGGER_SUPPORT
-      if(myJustHitTrapFlag)
+      if(INSTRUMENTED)
       {
-        if(myDebugger && myDebugger->start(myHitTrapInfo.message, myHitTrapInfo.address))
+        if(myJustHitTrapFlag)
         {
-          myJustHitTrapFlag = false;
-          return true;
+          if(myDebugger && myDebugger->start(myHitTrapInfo.message, myHitTrapInfo.address))
+          {
+            myJustHitTrapFlag = false;
+            return true;
+          }
         }
-      }
 
-      if(myBreakPoints.isInitialized() && myBreakPoints.isSet(PC))
-        if(myDebugger && myDebugger->start("BP: ", PC))
-          return true;
+        if(myBreakPoints.isInitialized() && myBreakPoints.isSet(PC))
+          if(myDebugger && myDebugger->start("BP: ", PC))
+            return true;
 
-      int cond = evalCondBreaks();
-      if(cond > -1)
-      {
-        string buf = "CBP: " + myBreakCondNames[cond];
-        if(myDebugger && myDebugger->start(buf))
-          return true;
+        int cond = evalCondBreaks();
+        if(cond > -1)
+        {
+          string buf = "CBP: " + myBreakCondNames[cond];
+          if(myDebugger && myDebugger->start(buf))
+            return true;
+        }
       }
 #endif  // DEBUGGER_SUPPORT
 
+      if(skipIdle && PC == myIdleLoopPC)
+        skipIdleLoop(number);
+
       uInt16 operandAddress = 0, intermediateAddress = 0;
       uInt8 operand = 0;
 
@@ -200,7 +237,7 @@ bool M6502::execute(uInt32 number)
       myLastPeekAddress = myLastPokeAddress = myDataAddressForPoke = 0;
 
       // Fetch instruction at the program counter
-      IR = peek(PC++, DISASM_CODE);  // This address represents a code section
+      IR = peek<INSTRUMENTED>(PC++, DISASM_CODE);  // This address represents a code section
 
       // Call code to execute the instruction
       switch(IR)
@@ -212,6 +249,11 @@ bool M6502::execute(uInt32 number)
           // Oops, illegal instruction executed so set fatal error flag
           myExecutionStatus |= FatalErrorBit;
       }
+
+      // Remember absolute mode reads of INTIM/TIMINT, as they may be the
+      // start of a polling loop
+      if(skipIdle && (myLastPeekAddress & 0x1284) == 0x0284)
+        myIdleLoopPC = uInt16(PC - 3);
     }
 
     // See if we need to handle an interrupt
@@ -245,6 +287,104 @@ bool M6502::execute(uInt32 number)
   }
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void M6502::skipIdleLoop(uInt32& number)
+{
+  // All addresses accessed by the loop code itself must be plain memory,
+  // so that reading them can't have any side effects (bankswitching, etc)
+  auto directPeek = [&](uInt16 address, uInt8& value) {
+    const System::PageAccess& access =
+        mySystem->getPageAccess((address & System::ADDRESS_MASK) >> System::PAGE_SHIFT);
+    if(!access.directPeekBase)
+      return false;
+    value = access.directPeekBase[address & System::PAGE_MASK];
+    return true;
+  };
+
+  // Accesses are: opcode, 2 byte address, timer register, branch opcode,
+  // branch offset, next opcode (dummy read) and possibly the page-crossing
+  // dummy read
+  uInt8 code[6];
+  for(uInt16 i = 0; i < 6; ++i)
+    if(!directPeek(PC + i, code[i]))
+      return;
+
+  const uInt8 opcode = code[0];
+  if(opcode != 0xad && opcode != 0xae && opcode != 0xac && opcode != 0x2c)
+    return;  // not LDA/LDX/LDY/BIT absolute
+  if(code[4] != 0xfb)
+    return;  // branch doesn't go back to the load
+
+  const uInt16 timer = code[1] | (uInt16(code[2]) << 8);
+  if((timer & 0x1284) != 0x0284 || mySystem->getPageAccess(
+     (timer & System::ADDRESS_MASK) >> System::PAGE_SHIFT).device != &mySystem->m6532())
+    return;
+
+  uInt16 lastAddress = PC + 5;
+  bool pageCrossed = (lastAddress ^ PC) & 0xff00;
+  if(pageCrossed)
+  {
+    uInt8 dummy;
+    lastAddress = (lastAddress & 0xff00) | (PC & 0x00ff);
+    if(!directPeek(lastAddress, dummy))
+      return;
+  }
+  const uInt32 accesses = pageCrossed ? 8 : 7;
+  const uInt32 cycles = accesses * SYSTEM_CYCLES_PER_CPU;
+
+  // Would the branch be taken for this value?
+  auto branchTaken = [&](uInt8 value) {
+    bool n = value & 0x80, v = V, z = value == 0;
+    if(opcode == 0x2c)  // BIT
+    {
+      v = value & 0x40;
+      z = (A & value) == 0;
+    }
+    switch(code[3])
+    {
+      case 0x10:  return !n;  // BPL
+      case 0x30:  return n;   // BMI
+      case 0x50:  return !v;  // BVC
+      case 0x70:  return v;   // BVS
+      case 0x90:  return !C;  // BCC
+      case 0xb0:  return C;   // BCS
+      case 0xd0:  return !z;  // BNE
+      case 0xf0:  return z;   // BEQ
+      default:    return false;
+    }
+  };
+
+  // Each iteration overwrites what the previous one loaded (the register
+  // and flags), so the state after any number of iterations which take the
+  // branch is the same.  Go through the timer values up to the one on which
+  // the loop exits (or up to the point where reading the timer has side
+  // effects), and skip all iterations reading the values before; the first
+  // one after them is emulated normally.  The timer is read on the fourth
+  // cycle of the loop.  One instruction must be left to run.
+  const uInt32 maxIterations = (number - 1) / 2;
+  const uInt32 firstRead = mySystem->cycles() + 4 * SYSTEM_CYCLES_PER_CPU;
+  uInt32 iterations = 0;
+  while(iterations < maxIterations)
+  {
+    uInt8 value = 0;
+    const uInt32 stable = mySystem->m6532().timerIdleCycles(timer,
+        firstRead + iterations * cycles, value);
+    if(stable == 0 || !branchTaken(value))
+      break;
+
+    // Iterations reading this value
+    iterations += std::min((stable - 1) / cycles + 1, maxIterations - iterations);
+  }
+  if(iterations == 0)
+    return;
+
+  mySystem->incrementCycles(iterations * cycles);
+  myNumberOfDistinctAccesses += iterations * accesses - (myLastAddress == PC ? 1 : 0);
+  myLastAddress = lastAddress;
+  number -= 2 * iterations;
+  mySkippedCycles += iterations * cycles;
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void M6502::interruptHandler()
 {
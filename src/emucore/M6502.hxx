@@ -164,6 +164,15 @@ class M6502 : public Serializable
     */
     uInt32 distinctAccesses() const { return myNumberOfDistinctAccesses; }
 
+    /**
+      Get/clear the number of system cycles which were skipped (rather
+      than emulated instruction by instruction) in RIOT timer polling loops
+
+      @return The number of cycles skipped since the last clear
+    */
+    uInt32 skippedCycles() const { return mySkippedCycles; }
+    void clearSkippedCycles() { mySkippedCycles = 0; }
+
     /**
       Saves the current state of this device to the given Serializer.
 
@@ -215,6 +224,7 @@ class M6502 : public Serializable
 
       @return The byte at the specified address
     */
+    template<bool INSTRUMENTED>
     uInt8 peek(uInt16 address, uInt8 flags);
 
     /**
@@ -224,6 +234,7 @@ class M6502 : public Serializable
       @param address  The address where the value should be stored
       @param value    The value to be stored at the address
     */
+    template<bool INSTRUMENTED>
     void poke(uInt16 address, uInt8 value);
 
     /**
@@ -265,6 +276,30 @@ class M6502 : public Serializable
     */
     void interruptHandler();
 
+    /**
+      Execute instructions, as execute() does.  When INSTRUMENTED is false,
+      this assumes that no breakpoints, traps or conditional breaks are set,
+      and leaves out all checks for them.
+
+      @param number Indicates the number of instructions to execute
+      @return true iff execution stops normally
+    */
+    template<bool INSTRUMENTED>
+    bool execute(uInt32 number);
+
+    /**
+      Called when the PC is at the start of a possible RIOT timer polling
+      loop (ie, 'LDA INTIM / BNE loop' or 'BIT TIMINT / BPL loop').  All
+      iterations up to the one reading the value that ends the loop (for
+      example INTIM reaching zero, or the timer flag being set) are skipped
+      by advancing the system cycle counter directly.  The resulting state
+      is exactly the same as if each iteration had been emulated.
+
+      @param number  The number of instructions left to execute; adjusted
+                     by the number of instructions skipped
+    */
+    void skipIdleLoop(uInt32& number);
+
   private:
     /**
       Bit fields used to indicate that certain conditions need to be
@@ -280,6 +315,16 @@ class M6502 : public Serializable
     };
     uInt8 myExecutionStatus;
 
+    /// Indicates whether to fast-forward through RIOT timer polling loops
+    bool mySkipIdleLoops;
+
+    /// Address of the instruction which last read INTIM/TIMINT, and is thus
+    /// a candidate for the start of a polling loop (-1 if none)
+    Int32 myIdleLoopPC;
+
+    /// Number of system cycles skipped in polling loops
+    uInt32 mySkippedCycles;
+
     /// Pointer to the system the processor is installed in or the null pointer
     System* mySystem;
 
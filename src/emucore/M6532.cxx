@@ -143,6 +143,41 @@ void M6532::updateEmulation()
   myLastCycle = mySystem->cycles();
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+uInt32 M6532::timerIdleCycles(uInt16 addr, uInt32 cycle, uInt8& value) const
+{
+  // This mirrors what updateEmulation() would do at the given cycle
+  uInt32 cycles = cycle - myLastCycle;
+  uInt32 timerTicks = (cycles + mySubTimer) / myDivider;
+  bool wrapped = myTimerWrapped || timerTicks > myTimer;
+
+  if(addr & 0x01)  // TIMINT
+  {
+    // Reading TIMINT only clears PA7, and the timer flag stays the same
+    // until the timer wraps; after that, it stays set
+    if(myInterruptFlag & PA7Bit)
+      return 0;
+
+    if(wrapped)
+    {
+      value = myInterruptFlag | TimerBit;
+      return ~0u;
+    }
+    value = myInterruptFlag;
+    return (myTimer + 1) * myDivider - mySubTimer - cycles;
+  }
+  else             // INTIM
+  {
+    // After the timer wraps, INTIM changes on every cycle, and reading it
+    // changes the timer state
+    if(wrapped || (myInterruptFlag & TimerBit))
+      return 0;
+
+    value = myTimer - timerTicks;
+    return (timerTicks + 1) * myDivider - mySubTimer - cycles;
+  }
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void M6532::install(System& system)
 {
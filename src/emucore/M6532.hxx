@@ -114,6 +114,30 @@ class M6532 : public Device
     */
     string name() const override { return "M6532"; }
 
+    /**
+      Get the entire contents of RAM, without changing the state of the
+      system (as a series of peeks would).
+
+      @return  A pointer to the 128 bytes of RAM
+    */
+    const uInt8* getRAM() const { return myRAM; }
+
+    /**
+      Used by the CPU to fast-forward through loops which do nothing but
+      poll INTIM or TIMINT.  Determine the value a read of the given timer
+      register at the given system cycle would return, and for how many
+      cycles from then on further reads would return the same value
+      without changing the state of the RIOT.
+
+      @param addr   The address of the timer register (INTIM or TIMINT)
+      @param cycle  The system cycle at which the first read occurs
+      @param value  Set to the value returned by the read(s)
+
+      @return  The number of cycles the value stays the same, or 0 if
+               reading at the given cycle has side effects
+    */
+    uInt32 timerIdleCycles(uInt16 addr, uInt32 cycle, uInt8& value) const;
+
    public:
     /**
       Get the byte at the specified address
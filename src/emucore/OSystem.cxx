@@ -16,8 +16,10 @@
 //============================================================================
 
 #include <cassert>
+#include <chrono>
 #include <sstream>
 #include <fstream>
+#include <thread>
 
 #include <ctime>
 #ifdef HAVE_GETTIMEOFDAY
@@ -51,6 +53,7 @@
 #include "Random.hxx"
 #include "SerialPort.hxx"
 #include "StateManager.hxx"
+#include "MovieRecorder.hxx"
 #include "Version.hxx"
 
 #include "OSystem.hxx"
@@ -79,12 +82,16 @@ OSystem::OSystem()
 
   // Get build info
   ostringstream info;
+#ifdef SDL_SUPPORT
   SDL_version ver;
   SDL_GetVersion(&ver);
 
   info << "Build " << STELLA_BUILD << ", using SDL " << int(ver.major)
        << "." << int(ver.minor) << "."<< int(ver.patch)
        << " [" << BSPF::ARCH << "]";
+#else
+  info << "Build " << STELLA_BUILD << ", headless [" << BSPF::ARCH << "]";
+#endif
   myBuildInfo = info.str();
 
   mySettings = MediaFactory::createSettings(*this);
@@ -154,7 +161,10 @@ bool OSystem::create()
   myRandom->initSeed();
 
   // Create PNG handler
-  myPNGLib = make_ptr<PNGLibrary>(*myFrameBuffer);
+  myPNGLib = make_ptr<PNGLibrary>(*this);
+
+  // Create the video/sound recorder
+  myMovieRecorder = make_ptr<MovieRecorder>(*this);
 
   return true;
 }
@@ -340,6 +350,19 @@ string OSystem::createConsole(const FilesystemNode& rom, const string& md5sum,
     }
     myConsole->initializeAudio();
 
+    const string& stream = mySettings->getString("stream");
+    if(stream != "")
+    {
+      try
+      {
+        myMovieRecorder->startStream(stream);
+      }
+      catch(const runtime_error& e)
+      {
+        logMessage(e.what(), 0);
+      }
+    }
+
     if(showmessage)
     {
       if(id == "")
@@ -549,6 +572,11 @@ void OSystem::closeConsole()
     // If a previous console existed, save cheats before creating a new one
     myCheatManager->saveCheats(myConsole->properties().get(Cartridge_MD5));
   #endif
+    // The recording and stream can't continue without the console
+    if(myMovieRecorder->isRecording())
+      logMessage(myMovieRecorder->stop(), 1);
+    if(myMovieRecorder->isStreaming())
+      logMessage(myMovieRecorder->stopStream(), 1);
     myConsole.reset();
   }
 }
@@ -662,7 +690,12 @@ void OSystem::mainLoop()
       }
 
       if(myTimingInfo.current < myTimingInfo.virt)
+      #ifdef SDL_SUPPORT
         SDL_Delay(uInt32(myTimingInfo.virt - myTimingInfo.current) / 1000);
+      #else
+        std::this_thread::sleep_for(std::chrono::microseconds(
+            myTimingInfo.virt - myTimingInfo.current));
+      #endif
 
       myTimingInfo.totalTime += (getTicks() - myTimingInfo.start);
       myTimingInfo.totalFrames++;
@@ -24,6 +24,7 @@ class Console;
 class Debugger;
 class Launcher;
 class Menu;
+class MovieRecorder;
 class Properties;
 class PropertiesSet;
 class Random;
@@ -162,6 +163,13 @@ class OSystem
     */
     PNGLibrary& png() const { return *myPNGLib; }
 
+    /**
+      Get the video/sound recorder of the system.
+
+      @return The MovieRecorder object
+    */
+    MovieRecorder& recorder() const { return *myMovieRecorder; }
+
     /**
       This method should be called to load the current settings from an rc file.
       It first loads the settings from the config file, then informs subsystems
@@ -471,6 +479,9 @@ class OSystem
     // PNG object responsible for loading/saving PNG images
     unique_ptr<PNGLibrary> myPNGLib;
 
+    // Recorder responsible for saving the emulated video and sound
+    unique_ptr<MovieRecorder> myMovieRecorder;
+
     // The list of log messages
     string myLogMessages;
 
@@ -0,0 +1,183 @@
+//============================================================================
+//
+//   SSSS    tt          lll  lll
+//  SS  SS   tt           ll   ll
+//  SS     tttttt  eeee   ll   ll   aaaa
+//   SSSS    tt   ee  ee  ll   ll      aa
+//      SS   tt   eeeeee  ll   ll   aaaaa  --  "An Atari 2600 VCS Emulator"
+//  SS  SS   tt   ee      ll   ll  aa  aa
+//   SSSS     ttt  eeeee llll llll  aaaaa
+//
+// Copyright (c) 1995-2017 by Bradford W. Mott, Stephen Anthony
+// and the Stella Team
+//
+// See the file "License.txt" for information on usage and redistribution of
+// this file, and for a DISCLAIMER OF ALL WARRANTIES.
+//============================================================================
+
+#include "RewindBuffer.hxx"
+
+namespace {
+  // Numbers are stored 7 bits per byte, with the top bit set in all but
+  // the last byte
+  uInt8* putNumber(uInt8* out, uInt32 value)
+  {
+    while(value >= 0x80)
+    {
+      *out++ = uInt8(value | 0x80);
+      value >>= 7;
+    }
+    *out++ = uInt8(value);
+    return out;
+  }
+
+  uInt32 getNumber(const uInt8*& in)
+  {
+    uInt32 value = 0;
+    for(int shift = 0; ; shift += 7)
+    {
+      const uInt8 byte = *in++;
+      value |= uInt32(byte & 0x7f) << shift;
+      if(!(byte & 0x80))
+        return value;
+    }
+  }
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+RewindBuffer::RewindBuffer()
+  : myCapacity(0),
+    myHead(0),
+    myEncodedLength(0)
+{
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void RewindBuffer::setCapacity(uInt32 size)
+{
+  myMemory = make_ptr<uInt8[]>(size);
+  myCapacity = size;
+  clear();
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void RewindBuffer::clear()
+{
+  myDeltas.clear();
+  myHead = 0;
+  myState.clear();
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void RewindBuffer::add(const uInt8* state, uInt32 size)
+{
+  if(!myState.empty())
+  {
+    // Store how to get the current newest state back from the new one
+    const bool key = size != myState.size();
+    encode(myState.data(), key ? nullptr : state, uInt32(myState.size()));
+
+    // Without room for even a single state, there's no history at all
+    if(!store(uInt32(myState.size()), key))
+    {
+      myDeltas.clear();
+      myHead = 0;
+    }
+  }
+  myState.assign(state, state + size);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool RewindBuffer::back()
+{
+  if(myDeltas.empty())
+    return false;
+
+  const Delta& delta = myDeltas.back();
+  if(delta.key)
+    myState.assign(delta.size, 0);
+  decode(myMemory.get() + delta.offset, delta.length, myState.data());
+
+  // This was the last delta stored, so its memory is used again next
+  myHead = delta.offset;
+  myDeltas.pop_back();
+
+  return true;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void RewindBuffer::encode(const uInt8* state, const uInt8* base, uInt32 size)
+{
+  const auto byte = [state, base](uInt32 i) {
+    return base ? uInt8(state[i] ^ base[i]) : state[i];
+  };
+
+  // A run ends at four zero bytes, so all but the last run cover at least
+  // five bytes; each run adds at most ten bytes for the two numbers
+  myEncoded.resize(size * 3 + 16);
+  uInt8* out = myEncoded.data();
+
+  uInt32 i = 0;
+  while(i < size)
+  {
+    const uInt32 skip = i;
+    while(i < size && byte(i) == 0)
+      ++i;
+    if(i == size)
+      break;
+
+    const uInt32 start = i;
+    uInt32 zeros = 0;
+    while(i < size && zeros < 4)
+    {
+      zeros = byte(i) == 0 ? zeros + 1 : 0;
+      ++i;
+    }
+    i -= zeros;
+
+    out = putNumber(out, start - skip);
+    out = putNumber(out, i - start);
+    for(uInt32 j = start; j < i; ++j)
+      *out++ = byte(j);
+  }
+  myEncodedLength = uInt32(out - myEncoded.data());
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void RewindBuffer::decode(const uInt8* in, uInt32 length, uInt8* state) const
+{
+  const uInt8* end = in + length;
+  uInt32 pos = 0;
+  while(in < end)
+  {
+    pos += getNumber(in);
+    for(uInt32 count = getNumber(in); count > 0; --count)
+      state[pos++] ^= *in++;
+  }
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool RewindBuffer::store(uInt32 size, bool key)
+{
+  const uInt32 length = myEncodedLength;
+  if(length > myCapacity)
+    return false;
+
+  // The deltas from myHead onwards are left from the previous time around
+  // the memory, and are the oldest ones, in order
+  if(length > myCapacity - myHead)
+  {
+    while(!myDeltas.empty() && myDeltas.front().offset >= myHead)
+      myDeltas.pop_front();
+    myHead = 0;
+  }
+  while(!myDeltas.empty() && myDeltas.front().offset >= myHead &&
+        myDeltas.front().offset < myHead + length)
+    myDeltas.pop_front();
+
+  memcpy(myMemory.get() + myHead, myEncoded.data(), length);
+  myDeltas.push_back({ myHead, length, size, key });
+  myHead += length;
+
+  return true;
+}
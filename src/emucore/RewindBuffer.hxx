@@ -0,0 +1,143 @@
+//============================================================================
+//
+//   SSSS    tt          lll  lll
+//  SS  SS   tt           ll   ll
+//  SS     tttttt  eeee   ll   ll   aaaa
+//   SSSS    tt   ee  ee  ll   ll      aa
+//      SS   tt   eeeeee  ll   ll   aaaaa  --  "An Atari 2600 VCS Emulator"
+//  SS  SS   tt   ee      ll   ll  aa  aa
+//   SSSS     ttt  eeeee llll llll  aaaaa
+//
+// Copyright (c) 1995-2017 by Bradford W. Mott, Stephen Anthony
+// and the Stella Team
+//
+// See the file "License.txt" for information on usage and redistribution of
+// this file, and for a DISCLAIMER OF ALL WARRANTIES.
+//============================================================================
+
+#ifndef REWIND_BUFFER_HXX
+#define REWIND_BUFFER_HXX
+
+#include <deque>
+
+#include "bspf.hxx"
+
+/**
+  This class keeps a history of serialized states in a fixed amount of
+  memory, for rewinding emulation.
+
+  Only the newest state is kept as is.  For each older state, the buffer
+  stores what has to be changed to get it back from the state after it:
+  the two states XOR'ed, with the runs of zero bytes (the parts that didn't
+  change) left out.  Since little of the system changes between states,
+  these deltas are small, and going back a state only takes applying one
+  of them.  When the size of the state changes (which is rare), the older
+  state is stored completely instead, as a key state.
+
+  The deltas are stored one after the other in a circular area of memory;
+  once it's full, the oldest states are dropped to make room.
+
+  @author  Stella Team
+*/
+class RewindBuffer
+{
+  public:
+    RewindBuffer();
+
+    /**
+      Set the amount of memory used to store the older states, and remove
+      all states.
+
+      @param size  The size of the memory, in bytes
+    */
+    void setCapacity(uInt32 size);
+
+    /**
+      Remove all states.
+    */
+    void clear();
+
+    /**
+      Add a state, which becomes the newest state.
+
+      @param state  The serialized state
+      @param size   The size of the state, in bytes
+    */
+    void add(const uInt8* state, uInt32 size);
+
+    /**
+      Remove the newest state, making the one before it the newest.
+
+      @return  False if there is no state before the newest one
+    */
+    bool back();
+
+    /**
+      Answers the newest state, or an empty state if there is none.
+    */
+    const uInt8* state() const { return myState.data(); }
+    uInt32 size() const { return uInt32(myState.size()); }
+
+    /**
+      Answers the number of states kept, including the newest one.
+    */
+    uInt32 count() const {
+      return myState.empty() ? 0 : uInt32(myDeltas.size()) + 1;
+    }
+
+  private:
+    /**
+      Encode 'state' XOR 'base' (or just 'state', if 'base' is nullptr)
+      into myEncoded, leaving out the zero bytes.
+
+      The encoding is a list of runs: the number of zero bytes to skip and
+      the number of bytes following, both as variable-length numbers, and
+      then these bytes.  Zero bytes at the end aren't stored at all.
+    */
+    void encode(const uInt8* state, const uInt8* base, uInt32 size);
+
+    /**
+      XOR the encoded runs into the given state.
+    */
+    void decode(const uInt8* in, uInt32 length, uInt8* state) const;
+
+    /**
+      Store myEncoded in the circular memory, dropping the oldest deltas
+      it overwrites.
+
+      @return  False if it doesn't fit at all
+    */
+    bool store(uInt32 size, bool key);
+
+  private:
+    // The older states, oldest first; each gives the state before the
+    // next one (or before the newest state, for the last one)
+    struct Delta {
+      uInt32 offset;  // location in myMemory
+      uInt32 length;  // number of bytes in myMemory
+      uInt32 size;    // size of the state it gives
+      bool key;       // the complete state, rather than a difference
+    };
+    std::deque<Delta> myDeltas;
+
+    // The memory holding the encoded deltas, and where the next one goes
+    unique_ptr<uInt8[]> myMemory;
+    uInt32 myCapacity;
+    uInt32 myHead;
+
+    // The newest state
+    vector<uInt8> myState;
+
+    // A delta is encoded here first, to find out how much room it needs
+    vector<uInt8> myEncoded;
+    uInt32 myEncodedLength;
+
+  private:
+    // Following constructors and assignment operators not supported
+    RewindBuffer(const RewindBuffer&) = delete;
+    RewindBuffer(RewindBuffer&&) = delete;
+    RewindBuffer& operator=(const RewindBuffer&) = delete;
+    RewindBuffer& operator=(RewindBuffer&&) = delete;
+};
+
+#endif
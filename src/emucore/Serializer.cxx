@@ -16,7 +16,6 @@
 //============================================================================
 
 #include <fstream>
-#include <sstream>
 
 #include "FSNode.hxx"
 #include "Serializer.hxx"
@@ -26,7 +25,11 @@ using std::ios_base;
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 Serializer::Serializer(const string& filename, bool readonly)
-  : myStream(nullptr)
+  : myStream(nullptr),
+    myCapacity(0),
+    mySize(0),
+    myWritePos(0),
+    myReadPos(0)
 {
   if(readonly)
   {
@@ -66,33 +69,46 @@ Serializer::Serializer(const string& filename, bool readonly)
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 Serializer::Serializer()
-  : myStream(nullptr)
+  : myStream(nullptr),
+    myBuffer(make_ptr<uInt8[]>(kInitialCapacity)),
+    myCapacity(kInitialCapacity),
+    mySize(0),
+    myWritePos(0),
+    myReadPos(0)
 {
-  myStream = make_ptr<stringstream>(ios::in | ios::out | ios::binary);
+}
 
-  // For some reason, Windows and possibly OSX needs to store something in
-  // the stream before it is used for the first time
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Serializer::reset()
+{
   if(myStream)
   {
-    myStream->exceptions( ios_base::failbit | ios_base::badbit | ios_base::eofbit );
-    putBool(true);
-    reset();
+    myStream->clear();
+    myStream->seekg(ios_base::beg);
+    myStream->seekp(ios_base::beg);
   }
+  else
+    myWritePos = myReadPos = 0;
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void Serializer::reset()
+void Serializer::grow(uInt32 size)
 {
-  myStream->clear();
-  myStream->seekg(ios_base::beg);
-  myStream->seekp(ios_base::beg);
+  uInt32 capacity = myCapacity;
+  while(capacity < size)
+    capacity *= 2;
+
+  unique_ptr<uInt8[]> buffer = make_ptr<uInt8[]>(capacity);
+  memcpy(buffer.get(), myBuffer.get(), mySize);
+  myBuffer = std::move(buffer);
+  myCapacity = capacity;
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 uInt8 Serializer::getByte() const
 {
-  char buf;
-  myStream->read(&buf, 1);
+  uInt8 buf;
+  read(&buf, 1);
 
   return buf;
 }
@@ -100,14 +116,14 @@ uInt8 Serializer::getByte() const
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Serializer::getByteArray(uInt8* array, uInt32 size) const
 {
-  myStream->read(reinterpret_cast<char*>(array), size);
+  read(array, size);
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 uInt16 Serializer::getShort() const
 {
   uInt16 val = 0;
-  myStream->read(reinterpret_cast<char*>(&val), sizeof(uInt16));
+  read(&val, sizeof(uInt16));
 
   return val;
 }
@@ -115,14 +131,14 @@ uInt16 Serializer::getShort() const
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Serializer::getShortArray(uInt16* array, uInt32 size) const
 {
-  myStream->read(reinterpret_cast<char*>(array), sizeof(uInt16)*size);
+  read(array, sizeof(uInt16)*size);
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 uInt32 Serializer::getInt() const
 {
   uInt32 val = 0;
-  myStream->read(reinterpret_cast<char*>(&val), sizeof(uInt32));
+  read(&val, sizeof(uInt32));
 
   return val;
 }
@@ -130,14 +146,14 @@ uInt32 Serializer::getInt() const
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Serializer::getIntArray(uInt32* array, uInt32 size) const
 {
-  myStream->read(reinterpret_cast<char*>(array), sizeof(uInt32)*size);
+  read(array, sizeof(uInt32)*size);
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 double Serializer::getDouble() const
 {
   double val = 0.0;
-  myStream->read(reinterpret_cast<char*>(&val), sizeof(double));
+  read(&val, sizeof(double));
 
   return val;
 }
@@ -148,7 +164,7 @@ string Serializer::getString() const
   int len = getInt();
   string str;
   str.resize(len);
-  myStream->read(&str[0], len);
+  read(&str[0], len);
 
   return str;
 }
@@ -162,43 +178,43 @@ bool Serializer::getBool() const
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Serializer::putByte(uInt8 value)
 {
-  myStream->write(reinterpret_cast<char*>(&value), 1);
+  write(&value, 1);
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Serializer::putByteArray(const uInt8* array, uInt32 size)
 {
-  myStream->write(reinterpret_cast<const char*>(array), size);
+  write(array, size);
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Serializer::putShort(uInt16 value)
 {
-  myStream->write(reinterpret_cast<char*>(&value), sizeof(uInt16));
+  write(&value, sizeof(uInt16));
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Serializer::putShortArray(const uInt16* array, uInt32 size)
 {
-  myStream->write(reinterpret_cast<const char*>(array), sizeof(uInt16)*size);
+  write(array, sizeof(uInt16)*size);
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Serializer::putInt(uInt32 value)
 {
-  myStream->write(reinterpret_cast<char*>(&value), sizeof(uInt32));
+  write(&value, sizeof(uInt32));
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Serializer::putIntArray(const uInt32* array, uInt32 size)
 {
-  myStream->write(reinterpret_cast<const char*>(array), sizeof(uInt32)*size);
+  write(array, sizeof(uInt32)*size);
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Serializer::putDouble(double value)
 {
-  myStream->write(reinterpret_cast<char*>(&value), sizeof(double));
+  write(&value, sizeof(double));
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -206,7 +222,7 @@ void Serializer::putString(const string& str)
 {
   int len = int(str.length());
   putInt(len);
-  myStream->write(str.data(), len);
+  write(str.data(), len);
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
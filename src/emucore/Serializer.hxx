@@ -26,6 +26,12 @@
   read from/written to a binary stream in a system-independent way.  The
   stream can be either an actual file, or an in-memory structure.
 
+  The in-memory structure is a contiguous buffer rather than an iostream,
+  since it's used for states that are saved and loaded often (such as
+  rewinding).  It grows as needed, and is kept when the serializer is reset
+  and used again, so after the first few uses no more memory is allocated.
+  The data written can be accessed directly (see data() and size()).
+
   Bytes are written as characters, shorts as 2 characters (16-bits),
   integers as 4 characters (32-bits), strings are written as characters
   prepended by the length of the string, boolean values are written using
@@ -43,7 +49,8 @@ class Serializer
       Creates a new Serializer device for streaming binary data.
 
       If a filename is provided, the stream will be to the given
-      filename.  Otherwise, the stream will be in memory.
+      filename.  Otherwise, the stream will be in memory; writing then
+      replaces all data after the location written to.
 
       If a file is opened readonly, we can never write to it.
 
@@ -58,13 +65,22 @@ class Serializer
       Answers whether the serializer is currently initialized for reading
       and writing.
     */
-    explicit operator bool() const { return myStream != nullptr; }
+    explicit operator bool() const {
+      return myStream != nullptr || myBuffer != nullptr;
+    }
 
     /**
       Resets the read/write location to the beginning of the stream.
     */
     void reset();
 
+    /**
+      Answers the data of an in-memory stream, without copying it.  For a
+      file, there is no data (nullptr and 0).
+    */
+    const uInt8* data() const { return myStream ? nullptr : myBuffer.get(); }
+    uInt32 size() const { return myStream ? 0 : mySize; }
+
     /**
       Reads a byte value (unsigned 8-bit) from the current input stream.
 
@@ -198,9 +214,54 @@ class Serializer
     void putBool(bool b);
 
   private:
-    // The stream to send the serialized data to.
+    /**
+      Read or write a block of data at the current location.  For the
+      in-memory stream, a runtime_error is thrown when reading past the
+      data written, the same as the file stream does at the end of file.
+    */
+    void read(void* data, uInt32 size) const {
+      if(myStream)
+        myStream->read(static_cast<char*>(data), size);
+      else
+      {
+        // A write may have truncated the data before the read position
+        if(myReadPos > mySize || size > mySize - myReadPos)
+          throw runtime_error("Serializer: read past end of data");
+        memcpy(data, myBuffer.get() + myReadPos, size);
+        myReadPos += size;
+      }
+    }
+    void write(const void* data, uInt32 size) {
+      if(myStream)
+        myStream->write(static_cast<const char*>(data), size);
+      else
+      {
+        if(size > myCapacity - myWritePos)
+          grow(myWritePos + size);
+        memcpy(myBuffer.get() + myWritePos, data, size);
+        mySize = myWritePos += size;
+      }
+    }
+
+    /**
+      Enlarge the in-memory buffer to hold at least the given number of
+      bytes, keeping its contents.
+    */
+    void grow(uInt32 size);
+
+  private:
+    // The stream to send the serialized data to, for a file
     unique_ptr<iostream> myStream;
 
+    // The in-memory buffer otherwise, with the size of the data and the
+    // write and read locations
+    unique_ptr<uInt8[]> myBuffer;
+    uInt32 myCapacity, mySize, myWritePos;
+    mutable uInt32 myReadPos;
+
+    // Initial size of the in-memory buffer; most states fit
+    static constexpr uInt32 kInitialCapacity = 1 << 13;
+
     enum {
       TruePattern  = 0xfe,
       FalsePattern = 0x01
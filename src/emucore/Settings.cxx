@@ -51,6 +51,7 @@ Settings::Settings(OSystem& osystem)
   setInternal("tia.aspectn", "90");
   setInternal("tia.aspectp", "100");
   setInternal("tia.fsfill", "false");
+  setInternal("tia.pipeline", "false");
 
   // TV filtering options
   setInternal("tv.filter", "0");
@@ -69,6 +70,7 @@ Settings::Settings(OSystem& osystem)
   setInternal("tv.artifacts", "0.0");
   setInternal("tv.fringing", "0.0");
   setInternal("tv.bleed", "0.0");
+  setInternal("tv.threads", "0");
 
   // Sound options
   setInternal("sound", "true");
@@ -97,6 +99,8 @@ Settings::Settings(OSystem& osystem)
   setInternal("sssingle", "false");
   setInternal("ss1x", "false");
   setInternal("ssinterval", "2");
+  setInternal("sszlevel", "6");
+  setInternal("ssfilter", "all");
 
   // Config files and paths
   setInternal("romdir", "");
@@ -127,16 +131,22 @@ Settings::Settings(OSystem& osystem)
 
   // Misc options
   setInternal("autoslot", "false");
+  setInternal("rewind", "false");
+  setInternal("rewindint", "4");
+  setInternal("rewindsize", "4");
   setInternal("loglevel", "1");
   setInternal("logtoconsole", "0");
   setInternal("tiadriven", "false");
   setInternal("cpurandom", "");
+  setInternal("idleskip", "true");
   setInternal("ramrandom", "true");
   setInternal("avoxport", "");
   setInternal("stats", "false");
+  setInternal("turbo", "false");
   setInternal("fastscbios", "false");
   setExternal("romloadcount", "0");
   setExternal("maxres", "");
+  setExternal("stream", "");
 
 #ifdef DEBUGGER_SUPPORT
   // Debugger/disassembly options
@@ -152,6 +162,17 @@ Settings::Settings(OSystem& osystem)
   // Thumb ARM emulation options
   setInternal("thumb.trapfatal", "true");
 #endif
+
+#ifdef HEADLESS
+  // Headless frontend options (never saved to the config file)
+  setExternal("hl.frames", "600");
+  setExternal("hl.video", "");
+  setExternal("hl.audio", "");
+  setExternal("hl.ram", "");
+  setExternal("hl.record", "");
+  setExternal("hl.ntscbench", "0");
+  setExternal("hl.convbench", "0");
+#endif
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -279,6 +300,9 @@ void Settings::validate()
   i = getInt("tv.jitter_recovery");
   if(i < 1 || i > 20)  setInternal("tv.jitter_recovery", "10");
 
+  i = getInt("tv.threads");
+  if(i < 0 || i > 8)  setInternal("tv.threads", "0");
+
 #ifdef SOUND_SUPPORT
   i = getInt("volume");
   if(i < 0 || i > 100)    setInternal("volume", "100");
@@ -303,10 +327,27 @@ void Settings::validate()
   if(i < 1)        setInternal("msense", "1");
   else if(i > 20)  setInternal("msense", "15");
 
+  i = getInt("rewindint");
+  if(i < 1)        setInternal("rewindint", "1");
+  else if(i > 60)  setInternal("rewindint", "60");
+
+  i = getInt("rewindsize");
+  if(i < 1)         setInternal("rewindsize", "1");
+  else if(i > 256)  setInternal("rewindsize", "256");
+
   i = getInt("ssinterval");
   if(i < 1)        setInternal("ssinterval", "2");
   else if(i > 10)  setInternal("ssinterval", "10");
 
+  i = getInt("sszlevel");
+  if(i < 0)       setInternal("sszlevel", "0");
+  else if(i > 9)  setInternal("sszlevel", "9");
+
+  s = getString("ssfilter");
+  if(s != "none" && s != "sub" && s != "up" && s != "avg" && s != "paeth" &&
+     s != "all")
+    setInternal("ssfilter", "all");
+
   s = getString("palette");
   if(s != "standard" && s != "z26" && s != "user")
     setInternal("palette", "standard");
@@ -368,6 +409,7 @@ void Settings::usage() const
     << "  -tia.aspectn  <number>       Scale TIA width by the given percentage in NTSC mode\n"
     << "  -tia.aspectp  <number>       Scale TIA width by the given percentage in PAL mode\n"
     << "  -tia.fsfill   <1|0>          Stretch TIA image to fill fullscreen mode\n"
+    << "  -tia.pipeline <1|0>          Emulate the next frame while showing one (adds a frame of lag)\n"
     << endl
     << "  -tv.filter    <0-5>          Set TV effects off (0) or to specified mode (1-5)\n"
     << "  -tv.scanlines <0-100>        Set scanline intensity to percentage (0 disables completely)\n"
@@ -384,6 +426,7 @@ void Settings::usage() const
     << "  -tv.artifacts   <value>      Set TV effects custom artifacts to value 1.0 - 1.0\n"
     << "  -tv.fringing    <value>      Set TV effects custom fringing to value 1.0 - 1.0\n"
     << "  -tv.bleed       <value>      Set TV effects custom bleed to value 1.0 - 1.0\n"
+    << "  -tv.threads   <0-8>          Number of threads used for TV effects (0 for automatic)\n"
     << endl
     << "  -cheat        <code>         Use the specified cheatcode (see manual for description)\n"
     << "  -loglevel     <0|1|2>        Set level of logging during application run\n"
@@ -400,7 +443,11 @@ void Settings::usage() const
     << "  -saport       <lr|rl>        How to assign virtual ports to multiple Stelladaptor/2600-daptors\n"
     << "  -ctrlcombo    <1|0>          Use key combos involving the Control key (Control-Q for quit may be disabled!)\n"
     << "  -autoslot     <1|0>          Automatically switch to next save slot when state saving\n"
+    << "  -rewind       <1|0>          Keep states during emulation, to rewind with the Rewind key\n"
+    << "  -rewindint    <number>       Number of frames between the states kept for rewinding (1-60)\n"
+    << "  -rewindsize   <number>       Memory used for rewinding, in MB (1-256)\n"
     << "  -stats        <1|0>          Overlay console info during emulation\n"
+    << "  -turbo        <1|0>          Run emulation as fast as possible, only drawing the frames shown\n"
     << "  -fastscbios   <1|0>          Disable Supercharger BIOS progress loading bars\n"
     << "  -snapsavedir  <path>         The directory to save snapshot files to\n"
     << "  -snaploaddir  <path>         The directory to load snapshot files from\n"
@@ -408,6 +455,10 @@ void Settings::usage() const
     << "  -sssingle     <1|0>          Generate single snapshot instead of many\n"
     << "  -ss1x         <1|0>          Generate TIA snapshot in 1x mode (ignore scaling/effects)\n"
     << "  -ssinterval   <number        Number of seconds between snapshots in continuous snapshot mode\n"
+    << "  -sszlevel     <0-9>          Compression level of snapshots (0 is fastest, 9 is smallest)\n"
+    << "  -ssfilter     <none|sub|up|  PNG filter used to compress snapshots\n"
+    << "                 avg|paeth|all>\n"
+    << "  -stream       <path>         Stream raw frames and sound to a named pipe or UNIX socket\n"
     << endl
     << "  -rominfo      <rom>          Display detailed information for the given ROM\n"
     << "  -listrominfo                 Display contents of stella.pro, one line per ROM entry\n"
@@ -436,8 +487,21 @@ void Settings::usage() const
     << "  -tiadriven    <1|0>          Drive unused TIA pins randomly on a read/peek\n"
     << "  -cpurandom    <1|0>          Randomize the contents of CPU registers on reset\n"
     << "  -ramrandom    <1|0>          Randomize the contents of RAM on reset\n"
+    << "  -idleskip     <1|0>          Skip over loops which only poll the RIOT timer\n"
     << "  -maxres       <WxH>          Used by developers to force the maximum size of the application window\n"
     << "  -help                        Show the text you're now reading\n"
+  #ifdef HEADLESS
+    << endl
+    << " The following options are only available in the headless build\n"
+    << endl
+    << "   -hl.frames        <number>  Number of frames to emulate before exiting\n"
+    << "   -hl.video         <file>    Dump each frame (as palette indices) to 'file'\n"
+    << "   -hl.audio         <file>    Log all audio register writes to 'file'\n"
+    << "   -hl.ram           <file>    Dump the 128 bytes of RIOT RAM per frame to 'file'\n"
+    << "   -hl.record        <file>    Record video and sound to 'file'.y4m and 'file'.wav\n"
+    << "   -hl.ntscbench     <number>  Time TV effects on the last frame 'number' times per preset\n"
+    << "   -hl.convbench     <number>  Time normal/phosphor conversion of the last frame 'number' times\n"
+  #endif
   #ifdef DEBUGGER_SUPPORT
     << endl
     << " The following options are meant for developers\n"
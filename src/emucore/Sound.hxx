@@ -120,6 +120,22 @@ class Sound : public Serializable
     */
     virtual void adjustVolume(Int8 direction) = 0;
 
+    /**
+      Answers the time from generating a sample until it's played, which
+      is kept steady by adjusting the sample rate (see SoundSDL2).
+
+      @return  The latency in milliseconds, or 0 when no sound is played
+    */
+    virtual uInt32 latency() const = 0;
+
+    /**
+      Answers how much the sample rate is currently adjusted, to keep the
+      sound in step with the emulation.
+
+      @return  The adjustment, in percent
+    */
+    virtual double rateAdjust() const = 0;
+
   protected:
     // The OSystem for this sound object
     OSystem& myOSystem;
@@ -24,6 +24,7 @@
 #include "Control.hxx"
 #include "Switches.hxx"
 #include "System.hxx"
+#include "TIA.hxx"
 #include "Serializable.hxx"
 
 #include "StateManager.hxx"
@@ -35,7 +36,9 @@
 StateManager::StateManager(OSystem& osystem)
   : myOSystem(osystem),
     myCurrentSlot(0),
-    myActiveMode(kOffMode)
+    myActiveMode(kOffMode),
+    myRewindInterval(1),
+    myRewindFrame(0)
 {
   reset();
 }
@@ -87,58 +90,78 @@ bool StateManager::toggleRecordMode()
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 bool StateManager::toggleRewindMode()
 {
-  // FIXME - For now, I'm going to use this to activate movie playback
-#if 0
-  // Close the writer, since we're about to re-open in read mode
-  myMovieWriter.close();
-
-  if(myActiveMode != kMoviePlaybackMode)  // Turn on movie playback mode
+  switch(myActiveMode)
   {
-    myActiveMode = kOffMode;
-
-    string moviefile = /*myOSystem.baseDir() + */ "test.inp";
-    if(myMovieReader.isOpen())
-      myMovieReader.close();
-    if(!myMovieReader.open(moviefile))
-      return false;
-
-    // Check the ROM md5
-    if(myMovieReader.getString() !=
-       myOSystem.console().properties().get(Cartridge_MD5))
-      return false;
-
-    if(!myOSystem.console().load(myMovieReader))
-      return false;
-
-    // Check controller types
-    const string& left  = myMovieReader.getString();
-    const string& right = myMovieReader.getString();
+    case kRewindRecordMode:
+      myActiveMode = kRewindPlaybackMode;
+      myRewindFrame = myOSystem.console().tia().frameCount();
+      break;
 
-    if(left != myOSystem.console().controller(Controller::Left).name() ||
-       right != myOSystem.console().controller(Controller::Right).name())
-      return false;
+    case kRewindPlaybackMode:
+      // Continue from the state reached; the states after it are gone
+      myActiveMode = kRewindRecordMode;
+      myRewindFrame = myOSystem.console().tia().frameCount();
+      break;
 
-    // If we get this far, we're really in movie record mode
-    myActiveMode = kMoviePlaybackMode;
-  }
-  else  // Turn off movie playback mode
-  {
-    myActiveMode = kOffMode;
-    myMovieReader.close();
-    return false;
+    default:
+      myOSystem.frameBuffer().showMessage("Rewind is disabled");
+      break;
   }
 
-  return myActiveMode == kMoviePlaybackMode;
-#endif
-  return false;
+  return myActiveMode == kRewindPlaybackMode;
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void StateManager::update()
 {
-#if 0
   switch(myActiveMode)
   {
+    case kRewindRecordMode:
+    {
+      // Several frames may have been emulated since the last update (in
+      // turbo mode, for example), and a loaded state may go back in time
+      const uInt32 frame = myOSystem.console().tia().frameCount();
+      if(frame - myRewindFrame >= myRewindInterval || frame < myRewindFrame)
+      {
+        myRewindFrame = frame;
+        myRewindState.reset();
+        if(saveState(myRewindState))
+          myRewindBuffer.add(myRewindState.data(), myRewindState.size());
+      }
+      break;
+    }
+
+    case kRewindPlaybackMode:
+    {
+      if(myRewindBuffer.count() == 0)
+        break;
+
+      // Step back one state each frame; the frame emulated after loading
+      // it is the one shown.  Past the oldest state, that one is loaded
+      // again, so emulation holds there until the key is released.
+      const bool stepped = myRewindBuffer.back();
+      myRewindState.reset();
+      myRewindState.putByteArray(myRewindBuffer.state(),
+                                 myRewindBuffer.size());
+      myRewindState.reset();
+      loadState(myRewindState);
+
+      ostringstream buf;
+      if(stepped)
+      {
+        const uInt32 frames =
+            myRewindFrame - myOSystem.console().tia().frameCount();
+        const uInt32 tenths =
+            uInt32(frames * 10 / myOSystem.console().getFramerate());
+        buf << "Rewind " << tenths / 10 << "." << tenths % 10 << "s";
+      }
+      else
+        buf << "Rewind history ended";
+      myOSystem.frameBuffer().showMessage(buf.str());
+      break;
+    }
+
+#if 0
     case kMovieRecordMode:
       myOSystem.console().controller(Controller::Left).save(myMovieWriter);
       myOSystem.console().controller(Controller::Right).save(myMovieWriter);
@@ -150,11 +173,11 @@ void StateManager::update()
       myOSystem.console().controller(Controller::Right).load(myMovieReader);
       myOSystem.console().switches().load(myMovieReader);
       break;
+#endif
 
     default:
       break;
   }
-#endif
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -348,4 +371,13 @@ void StateManager::reset()
   }
   myActiveMode = kOffMode;
 #endif
+
+  // States are kept during emulation, when rewind is enabled
+  const bool rewind = myOSystem.hasConsole() &&
+                      myOSystem.settings().getBool("rewind");
+  myRewindBuffer.setCapacity(
+      rewind ? myOSystem.settings().getInt("rewindsize") << 20 : 0);
+  myRewindInterval = myOSystem.settings().getInt("rewindint");
+  myRewindFrame = 0;
+  myActiveMode = rewind ? kRewindRecordMode : kOffMode;
 }
@@ -20,6 +20,7 @@
 
 class OSystem;
 
+#include "RewindBuffer.hxx"
 #include "Serializer.hxx"
 
 /**
@@ -27,6 +28,11 @@ class OSystem;
   States can be loaded or saved here, as well as recorded, rewound, and later
   played back.
 
+  For rewinding, a state is kept every few frames during emulation, in a
+  RewindBuffer of limited size.  While rewinding, each frame steps back to
+  the state before, holding at the oldest one; emulation then continues
+  from the state reached.
+
   @author  Stephen Anthony
 */
 class StateManager
@@ -43,7 +49,18 @@ class StateManager
     */
     bool isActive() const { return myActiveMode != kOffMode; }
 
+    /**
+      Answers whether emulation is being rewound
+    */
+    bool isRewinding() const { return myActiveMode == kRewindPlaybackMode; }
+
     bool toggleRecordMode();
+
+    /**
+      Start or stop rewinding, if rewind is enabled
+
+      @return  Whether emulation is being rewound now
+    */
     bool toggleRewindMode();
 
     /**
@@ -124,6 +141,16 @@ class StateManager
     Serializer myMovieWriter;
     Serializer myMovieReader;
 
+    // The states kept for rewinding, and the number of frames between them
+    RewindBuffer myRewindBuffer;
+    uInt32 myRewindInterval;
+
+    // The frame the last state was kept at, or the one rewinding started at
+    uInt32 myRewindFrame;
+
+    // A state being kept or restored
+    Serializer myRewindState;
+
   private:
     // Following constructors and assignment operators not supported
     StateManager() = delete;
@@ -15,6 +15,8 @@
 // this file, and for a DISCLAIMER OF ALL WARRANTIES.
 //============================================================================
 
+#include <cmath>
+
 #include "System.hxx"
 #include "TIATypes.hxx"
 #include "TIASnd.hxx"
@@ -23,9 +25,14 @@
 TIASound::TIASound(Int32 outputFrequency)
   : myChannelMode(Hardware2Stereo),
     myOutputFrequency(outputFrequency),
-    myOutputCounter(0),
-    myVolumePercentage(100)
+    myVolumePercentage(100),
+    myStep(31400.0 / outputFrequency),
+    myResamplerValid(false),
+    myNativeSize(0),
+    myPosition(0.0),
+    myTaps(0)
 {
+  initKernel();
   reset();
 }
 
@@ -52,13 +59,22 @@ void TIASound::reset()
     myP9[chan] = 0;
   }
 
-  myOutputCounter = 0;
+  resetResampler();
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void TIASound::outputFrequency(Int32 freq)
 {
   myOutputFrequency = freq;
+  myStep = 31400.0 / freq;
+  initKernel();
+  resetResampler();
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void TIASound::adjustFrequency(double ratio)
+{
+  myStep = 31400.0 / (myOutputFrequency * ratio);
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -68,6 +84,7 @@ string TIASound::channels(uInt32 hardware, bool stereo)
     myChannelMode = Hardware1;
   else
     myChannelMode = stereo ? Hardware2Stereo : Hardware2Mono;
+  resetResampler();
 
   switch(myChannelMode)
   {
@@ -161,209 +178,315 @@ void TIASound::volume(uInt32 percent)
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void TIASound::process(Int16* buffer, uInt32 samples)
 {
-  // Make temporary local copy
-  uInt8 audc0 = myAUDC[0], audc1 = myAUDC[1];
-  uInt8 p5_0 = myP5[0], p5_1 = myP5[1];
-  uInt8 div_n_cnt0 = myDivNCnt[0], div_n_cnt1 = myDivNCnt[1];
-  Int16 v0 = myVolume[0], v1 = myVolume[1];
-
-  // Take external volume into account
-  Int16 audv0 = (myAUDV[0] * myVolumePercentage) / 100,
-        audv1 = (myAUDV[1] * myVolumePercentage) / 100;
-
-  // Loop until the sample buffer is full
-  while(samples > 0)
+  // At the TIA rate, each clock gives one sample
+  if(myStep == 1.0)
   {
-    // Process channel 0
-    if (div_n_cnt0 > 1)
-    {
-      div_n_cnt0--;
-    }
-    else if (div_n_cnt0 == 1)
-    {
-      int prev_bit5 = Bit5[p5_0];
-      div_n_cnt0 = myDivNMax[0];
-
-      // The P5 counter has multiple uses, so we increment it here
-      p5_0++;
-      if (p5_0 == POLY5_SIZE)
-        p5_0 = 0;
-
-      // Check clock modifier for clock tick
-      if ((audc0 & 0x02) == 0 ||
-         ((audc0 & 0x01) == 0 && Div31[p5_0]) ||
-         ((audc0 & 0x01) == 1 && Bit5[p5_0]) ||
-         ((audc0 & 0x0f) == POLY5_DIV3 && Bit5[p5_0] != prev_bit5))
+    myResamplerValid = false;
+    run(samples, [&](Int16 v0, Int16 v1, uInt32 count) {
+      switch(myChannelMode)
       {
-        if (audc0 & 0x04)       // Pure modified clock selected
-        {
-          if ((audc0 & 0x0f) == POLY5_DIV3) // POLY5 -> DIV3 mode
-          {
-            if ( Bit5[p5_0] != prev_bit5 )
-            {
-              myDiv3Cnt[0]--;
-              if ( !myDiv3Cnt[0] )
-              {
-                myDiv3Cnt[0] = 3;
-                v0 = v0 ? 0 : audv0;
-              }
-            }
-          }
-          else
-          {
-            // If the output was set turn it off, else turn it on
-            v0 = v0 ? 0 : audv0;
-          }
-        }
-        else if (audc0 & 0x08)  // Check for p5/p9
-        {
-          if (audc0 == POLY9)   // Check for poly9
-          {
-            // Increase the poly9 counter
-            myP9[0]++;
-            if (myP9[0] == POLY9_SIZE)
-              myP9[0] = 0;
+        case Hardware2Mono:  // mono sampling with 2 hardware channels
+          std::fill_n(buffer, count * 2, Int16(v0 + v1));
+          buffer += count * 2;
+          break;
 
-            v0 = Bit9[myP9[0]] ? audv0 : 0;
-          }
-          else if ( audc0 & 0x02 )
+        case Hardware2Stereo:  // stereo sampling with 2 hardware channels
+          for(uInt32 i = 0; i < count; ++i)
           {
-            v0 = (v0 || audc0 & 0x01) ? 0 : audv0;
+            *(buffer++) = v0;
+            *(buffer++) = v1;
           }
-          else  // Must be poly5
-          {
-            v0 = Bit5[p5_0] ? audv0 : 0;
-          }
-        }
-        else  // Poly4 is the only remaining option
-        {
-          // Increase the poly4 counter
-          myP4[0]++;
-          if (myP4[0] == POLY4_SIZE)
-            myP4[0] = 0;
+          break;
 
-          v0 = Bit4[myP4[0]] ? audv0 : 0;
-        }
+        case Hardware1:  // mono/stereo sampling with only 1 hardware channel
+          std::fill_n(buffer, count, Int16(v0 + v1));
+          buffer += count;
+          break;
       }
-    }
+    });
+    return;
+  }
 
-    // Process channel 1
-    if (div_n_cnt1 > 1)
+  if(!myResamplerValid)
+    resetResampler();
+  if(samples == 0)
+    return;
+
+  // Generate the samples at the TIA rate, up to the last one the filter
+  // reaches for the last output sample
+  const bool stereo = myChannelMode == Hardware2Stereo;
+  const uInt32 needed =
+      uInt32(myPosition + (samples - 1) * myStep) + myTaps / 2 + 1;
+  if(needed > myNativeSize)
+  {
+    for(int chan = 0; chan < (stereo ? 2 : 1); ++chan)
+      if(myNative[chan].size() < needed)
+        myNative[chan].resize(needed);
+
+    auto append = [&](int chan, Int16 value, uInt32 count) {
+      Int16* native = myNative[chan].data() + myNativeSize;
+      if(value != native[-1])
+        myConstantFrom[chan] = myNativeSize;
+      std::fill_n(native, count, value);
+    };
+    run(needed - myNativeSize, [&](Int16 v0, Int16 v1, uInt32 count) {
+      if(stereo)
+      {
+        append(0, v0, count);
+        append(1, v1, count);
+      }
+      else
+        append(0, v0 + v1, count);
+      myNativeSize += count;
+    });
+  }
+
+  for(uInt32 i = 0; i < samples; ++i)
+  {
+    const uInt32 whole = uInt32(myPosition);
+    const uInt32 first = whole + 1 - myTaps / 2;
+    const double fraction = (myPosition - whole) * RESAMPLER_PHASES;
+    switch(myChannelMode)
     {
-      div_n_cnt1--;
+      case Hardware2Mono:  // mono sampling with 2 hardware channels
+        *buffer = *(buffer + 1) = resample(0, first, fraction);
+        buffer += 2;
+        break;
+
+      case Hardware2Stereo:  // stereo sampling with 2 hardware channels
+        *(buffer++) = resample(0, first, fraction);
+        *(buffer++) = resample(1, first, fraction);
+        break;
+
+      case Hardware1:  // mono/stereo sampling with only 1 hardware channel
+        *(buffer++) = resample(0, first, fraction);
+        break;
     }
-    else if (div_n_cnt1 == 1)
-    {
-      int prev_bit5 = Bit5[p5_1];
+    myPosition += myStep;
+  }
+
+  // Keep the samples the filter still reaches for the next output sample
+  const uInt32 done = uInt32(myPosition) + 1 - myTaps / 2;
+  for(int chan = 0; chan < (stereo ? 2 : 1); ++chan)
+  {
+    Int16* native = myNative[chan].data();
+    std::copy(native + done, native + myNativeSize, native);
+    myConstantFrom[chan] =
+        myConstantFrom[chan] > done ? myConstantFrom[chan] - done : 0;
+  }
+  myNativeSize -= done;
+  myPosition -= done;
+}
 
-      div_n_cnt1 = myDivNMax[1];
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+template<class Emit>
+void TIASound::run(uInt32 clocks, Emit emit)
+{
+  // Take external volume into account
+  const Int16 audv0 = (myAUDV[0] * myVolumePercentage) / 100,
+              audv1 = (myAUDV[1] * myVolumePercentage) / 100;
 
-      // The P5 counter has multiple uses, so we increment it here
-      p5_1++;
-      if (p5_1 == POLY5_SIZE)
-        p5_1 = 0;
+  while(clocks > 0)
+  {
+    // The output only changes when a counter runs out, so the clocks
+    // before that are a single run; a channel without a counter (volume
+    // only) never changes by itself
+    uInt32 count = clocks;
+    if(myDivNCnt[0] > 0)  count = std::min(count, uInt32(myDivNCnt[0] - 1));
+    if(myDivNCnt[1] > 0)  count = std::min(count, uInt32(myDivNCnt[1] - 1));
+    if(count > 0)
+    {
+      if(myDivNCnt[0] > 0)  myDivNCnt[0] -= count;
+      if(myDivNCnt[1] > 0)  myDivNCnt[1] -= count;
+      emit(myVolume[0], myVolume[1], count);
+      clocks -= count;
+    }
+    else
+    {
+      tick(0, audv0);
+      tick(1, audv1);
+      emit(myVolume[0], myVolume[1], 1);
+      --clocks;
+    }
+  }
+}
 
-      // Check clock modifier for clock tick
-      if ((audc1 & 0x02) == 0 ||
-         ((audc1 & 0x01) == 0 && Div31[p5_1]) ||
-         ((audc1 & 0x01) == 1 && Bit5[p5_1]) ||
-         ((audc1 & 0x0f) == POLY5_DIV3 && Bit5[p5_1] != prev_bit5))
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void TIASound::tick(int chan, Int16 audv)
+{
+  if(myDivNCnt[chan] > 1)
+  {
+    myDivNCnt[chan]--;
+    return;
+  }
+  else if(myDivNCnt[chan] == 0)
+    return;
+
+  const uInt8 audc = myAUDC[chan];
+  uInt8& p5 = myP5[chan];
+  Int16& v = myVolume[chan];
+
+  int prev_bit5 = Bit5[p5];
+  myDivNCnt[chan] = myDivNMax[chan];
+
+  // The P5 counter has multiple uses, so we increment it here
+  p5++;
+  if (p5 == POLY5_SIZE)
+    p5 = 0;
+
+  // Check clock modifier for clock tick
+  if ((audc & 0x02) == 0 ||
+     ((audc & 0x01) == 0 && Div31[p5]) ||
+     ((audc & 0x01) == 1 && Bit5[p5]) ||
+     ((audc & 0x0f) == POLY5_DIV3 && Bit5[p5] != prev_bit5))
+  {
+    if (audc & 0x04)       // Pure modified clock selected
+    {
+      if ((audc & 0x0f) == POLY5_DIV3) // POLY5 -> DIV3 mode
       {
-        if (audc1 & 0x04)       // Pure modified clock selected
-        {
-          if ((audc1 & 0x0f) == POLY5_DIV3)   // POLY5 -> DIV3 mode
-          {
-            if ( Bit5[p5_1] != prev_bit5 )
-            {
-              myDiv3Cnt[1]--;
-              if ( ! myDiv3Cnt[1] )
-              {
-                myDiv3Cnt[1] = 3;
-                v1 = v1 ? 0 : audv1;
-              }
-            }
-          }
-          else
-          {
-            // If the output was set turn it off, else turn it on
-            v1 = v1 ? 0 : audv1;
-          }
-        }
-        else if (audc1 & 0x08)  // Check for p5/p9
+        if ( Bit5[p5] != prev_bit5 )
         {
-          if (audc1 == POLY9)   // Check for poly9
-          {
-            // Increase the poly9 counter
-            myP9[1]++;
-            if (myP9[1] == POLY9_SIZE)
-              myP9[1] = 0;
-
-            v1 = Bit9[myP9[1]] ? audv1 : 0;
-          }
-          else if ( audc1 & 0x02 )
+          myDiv3Cnt[chan]--;
+          if ( !myDiv3Cnt[chan] )
           {
-            v1 = (v1 || audc1 & 0x01) ? 0 : audv1;
-          }
-          else  // Must be poly5
-          {
-            v1 = Bit5[p5_1] ? audv1 : 0;
+            myDiv3Cnt[chan] = 3;
+            v = v ? 0 : audv;
           }
         }
-        else  // Poly4 is the only remaining option
-        {
-          // Increase the poly4 counter
-          myP4[1]++;
-          if (myP4[1] == POLY4_SIZE)
-            myP4[1] = 0;
+      }
+      else
+      {
+        // If the output was set turn it off, else turn it on
+        v = v ? 0 : audv;
+      }
+    }
+    else if (audc & 0x08)  // Check for p5/p9
+    {
+      if (audc == POLY9)   // Check for poly9
+      {
+        // Increase the poly9 counter
+        myP9[chan]++;
+        if (myP9[chan] == POLY9_SIZE)
+          myP9[chan] = 0;
 
-          v1 = Bit4[myP4[1]] ? audv1 : 0;
-        }
+        v = Bit9[myP9[chan]] ? audv : 0;
+      }
+      else if ( audc & 0x02 )
+      {
+        v = (v || audc & 0x01) ? 0 : audv;
+      }
+      else  // Must be poly5
+      {
+        v = Bit5[p5] ? audv : 0;
       }
     }
+    else  // Poly4 is the only remaining option
+    {
+      // Increase the poly4 counter
+      myP4[chan]++;
+      if (myP4[chan] == POLY4_SIZE)
+        myP4[chan] = 0;
 
-    myOutputCounter += myOutputFrequency;
+      v = Bit4[myP4[chan]] ? audv : 0;
+    }
+  }
+}
 
-    switch(myChannelMode)
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void TIASound::initKernel()
+{
+  // The filter is a windowed sinc impulse (Blackman window), cut off just
+  // below half the output frequency; since the TIA holds each sample for
+  // a whole clock, each tap is the impulse integrated over its clock
+  const double pi = 3.14159265358979323846;
+  const double clock = myOutputFrequency / 31400.0;   // in output samples
+  const double width = RESAMPLER_WIDTH / clock;       // in clocks
+  const double cutoff = 0.45 * clock;                 // in cycles per clock
+  auto impulse = [&](double x) {
+    if(std::fabs(x) >= width / 2)
+      return 0.0;
+    const double t = 2 * pi * cutoff * x;
+    const double w = 2 * pi * x / width;
+    return (x == 0.0 ? 1.0 : std::sin(t) / t) *
+           (0.42 + 0.5 * std::cos(w) + 0.08 * std::cos(2 * w));
+  };
+  const int steps = 32;  // to integrate over a clock with
+
+  myTaps = 2 * uInt32(std::ceil(width / 2 + 2));
+  myKernel.resize((RESAMPLER_PHASES + 1) * myTaps);
+  vector<double> taps(myTaps);
+  for(uInt32 phase = 0; phase <= RESAMPLER_PHASES; ++phase)
+  {
+    // The output sample is 'x' clocks after the end of the clock of a tap
+    double sum = 0.0;
+    for(uInt32 i = 0; i < myTaps; ++i)
     {
-      case Hardware2Mono:  // mono sampling with 2 hardware channels
-        while((samples > 0) && (myOutputCounter >= 31400))
-        {
-          Int16 byte = v0 + v1;
-          *(buffer++) = byte;
-          *(buffer++) = byte;
-          myOutputCounter -= 31400;
-          samples--;
-        }
-        break;
-
-      case Hardware2Stereo:  // stereo sampling with 2 hardware channels
-        while((samples > 0) && (myOutputCounter >= 31400))
-        {
-          *(buffer++) = v0;
-          *(buffer++) = v1;
-          myOutputCounter -= 31400;
-          samples--;
-        }
-        break;
+      const double x = double(phase) / RESAMPLER_PHASES + myTaps / 2 - 2.0 - i;
+      taps[i] = 0.0;
+      for(int step = 0; step < steps; ++step)
+        taps[i] += impulse(x + (step + 0.5) / steps);
+      sum += taps[i];
+    }
 
-      case Hardware1:  // mono/stereo sampling with only 1 hardware channel
-        while((samples > 0) && (myOutputCounter >= 31400))
-        {
-          *(buffer++) = v0 + v1;
-          myOutputCounter -= 31400;
-          samples--;
-        }
-        break;
+    // Each row must add up to exactly 1, so a constant output stays
+    // exactly the same; the rounding error is put into the largest tap
+    Int16* kernel = &myKernel[phase * myTaps];
+    Int32 total = 0;
+    uInt32 largest = 0;
+    for(uInt32 i = 0; i < myTaps; ++i)
+    {
+      kernel[i] = Int16(std::round(taps[i] / sum * (1 << RESAMPLER_SHIFT)));
+      total += kernel[i];
+      if(kernel[i] > kernel[largest])
+        largest = i;
     }
+    kernel[largest] += (1 << RESAMPLER_SHIFT) - total;
   }
+}
 
-  // Save for next round
-  myP5[0] = p5_0;
-  myP5[1] = p5_1;
-  myVolume[0] = v0;
-  myVolume[1] = v1;
-  myDivNCnt[0] = div_n_cnt0;
-  myDivNCnt[1] = div_n_cnt1;
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void TIASound::resetResampler()
+{
+  // Start with enough samples of the current output for the filter to
+  // reach back to
+  const bool stereo = myChannelMode == Hardware2Stereo;
+  myNativeSize = myTaps / 2;
+  for(int chan = 0; chan <= 1; ++chan)
+  {
+    const Int16 value = stereo ? myVolume[chan] :
+                        chan == 0 ? myVolume[0] + myVolume[1] : 0;
+    if(myNative[chan].size() < myNativeSize)
+      myNative[chan].resize(myNativeSize);
+    std::fill_n(myNative[chan].begin(), myNativeSize, value);
+    myConstantFrom[chan] = 0;
+  }
+  myPosition = myTaps / 2 - 1;
+  myResamplerValid = true;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Int16 TIASound::resample(int chan, uInt32 first, double fraction) const
+{
+  // Nothing to filter if the output doesn't change within its reach
+  const Int16* native = myNative[chan].data() + first;
+  if(first >= myConstantFrom[chan])
+    return *native;
+
+  // Interpolate between the rows of the filter for the fractions of a
+  // clock around the position of the output sample; the filter can
+  // overshoot the range of the output a bit
+  const uInt32 phase = uInt32(fraction);
+  const Int16* kernel0 = &myKernel[phase * myTaps];
+  const Int16* kernel1 = kernel0 + myTaps;
+  Int32 sum0 = 0, sum1 = 0;
+  for(uInt32 i = 0; i < myTaps; ++i)
+  {
+    sum0 += native[i] * kernel0[i];
+    sum1 += native[i] * kernel1[i];
+  }
+  const double sum = sum0 + (sum1 - sum0) * (fraction - phase);
+  return Int16(BSPF::clamp(Int32(std::lround(sum / (1 << RESAMPLER_SHIFT))),
+                           -32768, 32767));
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -24,8 +24,12 @@
   This class implements a fairly accurate emulation of the TIA sound
   hardware.  This class uses code/ideas from z26 and MESS.
 
-  Currently, the sound generation routines work at 31400Hz only.
-  Resampling can be done by passing in a different output frequency.
+  The sound is generated at the 31400Hz rate of the TIA, in runs of
+  constant output between the clocks of the two channels.  For other
+  output frequencies, those samples are passed through a polyphase
+  resampler, which band-limits the output (as held for a whole clock by
+  the TIA) below half the output frequency, instead of simply repeating
+  or dropping samples.
 
   @author  Bradford W. Mott, Stephen Anthony, z26 and MESS teams
 */
@@ -48,6 +52,14 @@ class TIASound
     */
     void outputFrequency(Int32 freq);
 
+    /**
+      Make the output frequency slightly higher or lower than the one set,
+      without interrupting the sound.
+
+      @param ratio  The factor to multiply the output frequency with
+    */
+    void adjustFrequency(double ratio);
+
     /**
       Selects the number of audio channels per sample.  There are two factors
       to consider: hardware capability and desired mixing.
@@ -94,6 +106,44 @@ class TIASound
   private:
     void polyInit(uInt8* poly, int size, int f0, int f1);
 
+    /**
+      Advance the 'divide by n' counter of a channel by one TIA sound
+      clock, updating its output when the counter runs out.
+
+      @param chan  The channel (0 or 1)
+      @param audv  The volume of the channel
+    */
+    void tick(int chan, Int16 audv);
+
+    /**
+      Run both channels for the given number of TIA sound clocks, passing
+      each run of clocks with constant output to 'emit' as (v0, v1, count).
+    */
+    template<class Emit>
+    void run(uInt32 clocks, Emit emit);
+
+    /**
+      Calculate the filter of the resampler for the output frequency,
+      for each fraction of a TIA sound clock.
+    */
+    void initKernel();
+
+    /**
+      Discard the samples not output yet, and continue from the current
+      output of the channels.
+    */
+    void resetResampler();
+
+    /**
+      Calculate an output sample from the samples at the TIA rate.
+
+      @param chan      The output channel (0 or 1)
+      @param first     The first of the samples the filter reaches
+      @param fraction  The position of the output sample after the clock
+                       it's in, in fractions of a clock
+    */
+    Int16 resample(int chan, uInt32 first, double fraction) const;
+
   private:
     // Definitions for AUDCx (15, 16)
     enum AUDCxRegister
@@ -125,6 +175,12 @@ class TIASound
                           // then another 8 for 16-bit sound
     };
 
+    enum {
+      RESAMPLER_PHASES = 64,  // fractions of a clock the filter is stored for
+      RESAMPLER_WIDTH  = 32,  // output samples the filter is spread over
+      RESAMPLER_SHIFT  = 14   // fixed point bits of the filter
+    };
+
     enum ChannelMode {
       Hardware2Mono,    // mono sampling with 2 hardware channels
       Hardware2Stereo,  // stereo sampling with 2 hardware channels
@@ -149,9 +205,31 @@ class TIASound
 
     ChannelMode myChannelMode;
     Int32  myOutputFrequency;
-    Int32  myOutputCounter;
     uInt32 myVolumePercentage;
 
+    // Length of an output sample in TIA sound clocks
+    double myStep;
+
+    // The resampler isn't kept up to date while the output is at exactly
+    // 31400Hz, so it's restarted when it changes from that
+    bool myResamplerValid;
+
+    // For each output channel, the samples at the TIA rate still reached
+    // by the filter, and the first of them since which the output hasn't
+    // changed (the filter isn't needed from there on)
+    vector<Int16> myNative[2];
+    uInt32 myNativeSize;
+    uInt32 myConstantFrom[2];
+
+    // Position of the next output sample in the samples above, in clocks
+    double myPosition;
+
+    // The filter for each fraction of a clock (plus the next whole clock,
+    // to interpolate between them), each row summing up to
+    // 1 << RESAMPLER_SHIFT and spanning myTaps clocks
+    uInt32 myTaps;
+    vector<Int16> myKernel;
+
     /*
       Initialize the bit patterns for the polynomials (at runtime).
 
@@ -25,6 +25,211 @@
 
 #include "TIASurface.hxx"
 
+#if defined(__SSE2__)
+  #include <emmintrin.h>
+#elif defined(__ARM_NEON)
+  #include <arm_neon.h>
+#endif
+
+#if (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+  #define TIASURFACE_AVX2
+  #include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+  #define TIASURFACE_NEON
+#endif
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static void expandLineScalar(const uInt8* src, uInt32* dst, uInt32 width,
+                             const uInt32* palette)
+{
+  for(uInt32 x = 0; x < width; ++x)
+    dst[x] = palette[src[x]];
+}
+
+#if defined(TIASURFACE_AVX2)
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// Compiled for AVX2 regardless of the build flags; only called after
+// the CPU has been checked for support
+__attribute__((target("avx2")))
+static void expandLineAVX2(const uInt8* src, uInt32* dst, uInt32 width,
+                           const uInt32* palette)
+{
+  const int* table = reinterpret_cast<const int*>(palette);
+  uInt32 x = 0;
+
+  // Widen 16 indices to 32 bits and gather their colours, 8 at a time
+  for(; x + 16 <= width; x += 16)
+  {
+    const __m128i idx = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x));
+    const __m256i lo = _mm256_i32gather_epi32(table, _mm256_cvtepu8_epi32(idx), 4);
+    const __m256i hi = _mm256_i32gather_epi32(table,
+                         _mm256_cvtepu8_epi32(_mm_srli_si128(idx, 8)), 4);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x), lo);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x + 8), hi);
+  }
+  expandLineScalar(src + x, dst + x, width - x, palette);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static bool haveAVX2()
+{
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+}
+#endif
+
+#if defined(TIASURFACE_NEON)
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// Each byte plane of the palette is 256 bytes, ie. four 64 byte tables
+// for TBL/TBX.  Lookups are done a plane at a time over a chunk of the
+// line so the tables stay in registers, then the planes are interleaved
+// back into pixels.
+static void expandLineNEON(const uInt8* src, uInt32* dst, uInt32 width,
+                           const uInt8 (*planes)[256], const uInt32* palette)
+{
+  uInt8 chunk[4][64];
+  uInt32 x = 0;
+
+  while(width - x >= 16)
+  {
+    const uInt32 n = std::min((width - x) & ~15u, 64u);
+
+    for(int k = 0; k < 4; ++k)
+    {
+      uint8x16x4_t t[4];
+      for(int j = 0; j < 4; ++j)
+        for(int q = 0; q < 4; ++q)
+          t[j].val[q] = vld1q_u8(planes[k] + j*64 + q*16);
+
+      for(uInt32 i = 0; i < n; i += 16)
+      {
+        // Indices outside a table leave the result untouched with TBX
+        const uint8x16_t idx = vld1q_u8(src + x + i);
+        uint8x16_t v = vqtbl4q_u8(t[0], idx);
+        v = vqtbx4q_u8(v, t[1], vsubq_u8(idx, vdupq_n_u8(64)));
+        v = vqtbx4q_u8(v, t[2], vsubq_u8(idx, vdupq_n_u8(128)));
+        v = vqtbx4q_u8(v, t[3], vsubq_u8(idx, vdupq_n_u8(192)));
+        vst1q_u8(chunk[k] + i, v);
+      }
+    }
+    for(uInt32 i = 0; i < n; i += 16)
+    {
+      uint8x16x4_t pixels;
+      for(int k = 0; k < 4; ++k)
+        pixels.val[k] = vld1q_u8(chunk[k] + i);
+      vst4q_u8(reinterpret_cast<uInt8*>(dst + x + i), pixels);
+    }
+    x += n;
+  }
+  expandLineScalar(src + x, dst + x, width - x, palette);
+}
+#endif
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// Phosphor blending of pixel 't' of the current frame with pixel 'a' of the
+// previous image, each channel separately: the result is the darker of both
+// plus 'weight'/256 of the difference, rounded towards the current frame
+// (so that a static image eventually settles on its actual colours)
+static inline uInt32 blendPixel(uInt32 t, uInt32 a, uInt32 weight)
+{
+  uInt32 result = 0;
+  for(int shift = 0; shift < 32; shift += 8)
+  {
+    const uInt32 ct = (t >> shift) & 0xff, ca = (a >> shift) & 0xff;
+    const uInt32 lo = std::min(ct, ca), hi = std::max(ct, ca);
+    const uInt32 bias = ct >= ca ? 255 : 0;
+    result |= (lo + (((hi - lo) * weight + bias) >> 8)) << shift;
+  }
+  return result;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// Blend a line of 'width' pixels in 'line' with the same line of the
+// phosphor buffer 'acc', storing the result in both; answers whether any
+// pixel differs from the current frame, ie. is still fading
+static bool blendLineScalar(uInt32* line, uInt32* acc, uInt32 width,
+                            uInt32 weight)
+{
+  bool fading = false;
+  for(uInt32 x = 0; x < width; ++x)
+  {
+    const uInt32 t = line[x];
+    if(t == acc[x])
+      continue;
+
+    const uInt32 blended = blendPixel(t, acc[x], weight);
+    line[x] = acc[x] = blended;
+    fading |= blended != t;
+  }
+  return fading;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// Same as blendLineScalar(), four pixels (16 channels) at a time
+static bool blendLine(uInt32* line, uInt32* acc, uInt32 width, uInt32 weight)
+{
+  uInt32 x = 0;
+  bool fading = false;
+
+#if defined(__SSE2__)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i w = _mm_set1_epi16(Int16(weight));
+  __m128i same = _mm_set1_epi8(-1);
+
+  for(; x + 4 <= width; x += 4)
+  {
+    const __m128i t = _mm_loadu_si128(reinterpret_cast<const __m128i*>(line + x));
+    const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc + x));
+    const __m128i hi = _mm_max_epu8(t, a), lo = _mm_min_epu8(t, a);
+    const __m128i diff = _mm_sub_epi8(hi, lo);
+    const __m128i bias = _mm_cmpeq_epi8(hi, t);
+
+    const __m128i rlo = _mm_srli_epi16(_mm_add_epi16(
+        _mm_mullo_epi16(_mm_unpacklo_epi8(diff, zero), w),
+        _mm_unpacklo_epi8(bias, zero)), 8);
+    const __m128i rhi = _mm_srli_epi16(_mm_add_epi16(
+        _mm_mullo_epi16(_mm_unpackhi_epi8(diff, zero), w),
+        _mm_unpackhi_epi8(bias, zero)), 8);
+    const __m128i blended = _mm_add_epi8(lo, _mm_packus_epi16(rlo, rhi));
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(line + x), blended);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(acc + x), blended);
+    same = _mm_and_si128(same, _mm_cmpeq_epi8(blended, t));
+  }
+  fading = _mm_movemask_epi8(same) != 0xffff;
+#elif defined(__ARM_NEON)
+  const uint16x8_t w = vdupq_n_u16(uInt16(weight));
+  uint8x16_t same = vdupq_n_u8(0xff);
+
+  for(; x + 4 <= width; x += 4)
+  {
+    const uint8x16_t t = vld1q_u8(reinterpret_cast<const uInt8*>(line + x));
+    const uint8x16_t a = vld1q_u8(reinterpret_cast<const uInt8*>(acc + x));
+    const uint8x16_t lo = vminq_u8(t, a);
+    const uint8x16_t diff = vabdq_u8(t, a);
+    const uint8x16_t bias = vcgeq_u8(t, a);
+
+    const uint16x8_t rlo = vshrq_n_u16(vaddq_u16(
+        vmulq_u16(vmovl_u8(vget_low_u8(diff)), w),
+        vmovl_u8(vget_low_u8(bias))), 8);
+    const uint16x8_t rhi = vshrq_n_u16(vaddq_u16(
+        vmulq_u16(vmovl_u8(vget_high_u8(diff)), w),
+        vmovl_u8(vget_high_u8(bias))), 8);
+    const uint8x16_t blended =
+        vaddq_u8(lo, vcombine_u8(vmovn_u16(rlo), vmovn_u16(rhi)));
+
+    vst1q_u8(reinterpret_cast<uInt8*>(line + x), blended);
+    vst1q_u8(reinterpret_cast<uInt8*>(acc + x), blended);
+    same = vandq_u8(same, vceqq_u8(blended, t));
+  }
+  const uint64x2_t all = vreinterpretq_u64_u8(same);
+  fading = (vgetq_lane_u64(all, 0) & vgetq_lane_u64(all, 1)) != ~uInt64(0);
+#endif
+
+  return blendLineScalar(line + x, acc + x, width - x, weight) || fading;
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 TIASurface::TIASurface(OSystem& system)
   : myOSystem(system),
@@ -34,7 +239,13 @@ TIASurface::TIASurface(OSystem& system)
     myUsePhosphor(false),
     myPhosphorBlend(77),
     myScanlinesEnabled(false),
-    myPalette(nullptr)
+    myRedrawAll(true),
+    myLastFrame(0),
+    myLastHeight(0),
+    myPalette(nullptr),
+    mySIMD(true),
+    myDirectAccess(false),
+    myFrameHeld(false)
 {
   // Load NTSC filter settings
   myNTSCFilter.loadConfig(myOSystem.settings());
@@ -53,12 +264,16 @@ TIASurface::TIASurface(OSystem& system)
 
   // Base TIA surface for use in taking snapshots in 1x mode
   myBaseTiaSurface = myFB.allocateSurface(kTIAW*2, kTIAH);
+
+  myPhosphorBuffer = make_ptr<uInt32[]>(kPhosphorPitch * kTIAH);
+  myHeldFrame = make_ptr<uInt8[]>(kTIAW * kTIAH);
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void TIASurface::initialize(const Console& console, const VideoMode& mode)
 {
   myTIA = &(console.tia());
+  myRedrawAll = true;
 
   myTiaSurface->setDstPos(mode.image.x(), mode.image.y());
   myTiaSurface->setDstSize(mode.image.width(), mode.image.height());
@@ -94,30 +309,18 @@ cerr << "SLine:\n"
 void TIASurface::setPalette(const uInt32* tia_palette, const uInt32* rgb_palette)
 {
   myPalette = tia_palette;
+  myRedrawAll = true;
 
-  // Set palette for phosphor effect
+#if defined(TIASURFACE_NEON)
+  // Plane k holds byte k (in memory order) of each palette entry
   for(int i = 0; i < 256; ++i)
-  {
-    for(int j = 0; j < 256; ++j)
-    {
-      uInt8 ri = (rgb_palette[i] >> 16) & 0xff;
-      uInt8 gi = (rgb_palette[i] >> 8) & 0xff;
-      uInt8 bi = rgb_palette[i] & 0xff;
-      uInt8 rj = (rgb_palette[j] >> 16) & 0xff;
-      uInt8 gj = (rgb_palette[j] >> 8) & 0xff;
-      uInt8 bj = rgb_palette[j] & 0xff;
-
-      uInt8 r = getPhosphor(ri, rj);
-      uInt8 g = getPhosphor(gi, gj);
-      uInt8 b = getPhosphor(bi, bj);
-
-      myPhosphorPalette[i][j] = myFB.mapRGB(r, g, b);
-    }
-  }
+    for(int k = 0; k < 4; ++k)
+      myPalettePlanes[k][i] = reinterpret_cast<const uInt8*>(&myPalette[i])[k];
+#endif
 
   // The NTSC filtering needs access to the raw RGB data, since it calculates
   // its own internal palette
-  myNTSCFilter.setTIAPalette(*this, rgb_palette);
+  myNTSCFilter.setTIAPalette(rgb_palette);
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -130,26 +333,138 @@ const FBSurface& TIASurface::baseSurface(GUI::Rect& rect)
   uInt32 *buf_ptr, pitch;
   myBaseTiaSurface->basePtr(buf_ptr, pitch);
 
+  // In phosphor mode, the image shown is the one in the phosphor buffer
+  const bool shown = myFilterType == kPhosphor;
   for(uInt32 y = 0; y < height; ++y)
   {
+    const uInt32* line = myPhosphorBuffer.get() + y * kPhosphorPitch;
     for(uInt32 x = 0; x < tiaw; ++x)
     {
-      uInt32 pixel = myFB.tiaSurface().pixel(y*tiaw+x);
-      *buf_ptr++ = pixel;
-      *buf_ptr++ = pixel;
+      uInt32 color = shown ? line[x] : pixel(y*tiaw+x);
+      *buf_ptr++ = color;
+      *buf_ptr++ = color;
     }
   }
 
   return *myBaseTiaSurface;
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void TIASurface::captureImage(Image& image)
+{
+  const uInt32 tiaw = myTIA->width(), height = myTIA->height();
+  const uInt32 width = (myFilterType & 0x10) ? ATARI_NTSC_OUT_WIDTH(tiaw) : tiaw;
+
+  // In phosphor mode, the image shown is the one in the phosphor buffer;
+  // otherwise the current frame is converted the same way render() does
+  image.pixels = make_ptr<uInt32[]>(width * height);
+  if(myFilterType & 0x01)
+  {
+    for(uInt32 y = 0; y < height; ++y)
+      memcpy(image.pixels.get() + y * width,
+             myPhosphorBuffer.get() + y * kPhosphorPitch,
+             width * sizeof(uInt32));
+  }
+  else
+    renderLines(myTIA->currentFrameBuffer(), tiaw, 0, height,
+                image.pixels.get(), width);
+
+  const FBSurface::Attributes& sl_attr = mySLineSurface->attributes();
+  image.width             = width;
+  image.height            = height;
+  image.scaledWidth       = myTiaSurface->dstRect().width();
+  image.scaledHeight      = myTiaSurface->dstRect().height();
+  image.smoothing         = myTiaSurface->attributes().smoothing;
+  image.scanlines         = myScanlinesEnabled ? sl_attr.blendalpha : 0;
+  image.scanlineRows      = mySLineSurface->srcRect().height();
+  image.scanlineSmoothing = sl_attr.smoothing;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void TIASurface::scaleImage(const Image& image, uInt32* buffer)
+{
+  // Blend 'a' and 'b' by 'f' / 256, per byte
+  auto mix = [](uInt32 a, uInt32 b, uInt32 f) -> uInt32 {
+    const uInt32 rb = (a & 0xFF00FF) * (256 - f) + (b & 0xFF00FF) * f;
+    const uInt32 ag = ((a >> 8) & 0xFF00FF) * (256 - f) + ((b >> 8) & 0xFF00FF) * f;
+    return ((rb >> 8) & 0xFF00FF) | (ag & 0xFF00FF00);
+  };
+
+  // Position of the centre of scaled pixel 'i' in the source, in 1/256,
+  // for 'n' source pixels scaled to 'scaled' pixels
+  auto position = [](uInt32 i, uInt32 n, uInt32 scaled) -> uInt32 {
+    const Int64 pos = (Int64(2 * i + 1) * n * 256) / (2 * scaled) - 128;
+    return uInt32(BSPF::clamp(pos, Int64(0), Int64(n - 1) * 256));
+  };
+
+  const uInt32 w = image.width, h = image.height;
+  const uInt32 sw = image.scaledWidth, sh = image.scaledHeight;
+  vector<uInt32> columns(sw), fractions(sw);
+  for(uInt32 x = 0; x < sw; ++x)
+  {
+    const uInt32 pos = image.smoothing ? position(x, w, sw) :
+                                         (2 * x + 1) * w / (2 * sw) * 256;
+    columns[x] = pos >> 8;
+    fractions[x] = pos & 0xFF;
+  }
+
+  for(uInt32 y = 0; y < sh; ++y, buffer += sw)
+  {
+    const uInt32 pos = image.smoothing ? position(y, h, sh) :
+                                         (2 * y + 1) * h / (2 * sh) * 256;
+    const uInt32* line0 = image.pixels.get() + (pos >> 8) * w;
+    const uInt32* line1 = line0 + (pos >> 8 < h - 1 ? w : 0);
+    const uInt32 fy = pos & 0xFF;
+
+    for(uInt32 x = 0; x < sw; ++x)
+    {
+      const uInt32 x0 = columns[x], x1 = std::min(x0 + 1, w - 1);
+      const uInt32 top = mix(line0[x0], line0[x1], fractions[x]);
+      buffer[x] = fy == 0 ? top :
+                  mix(top, mix(line1[x0], line1[x1], fractions[x]), fy);
+    }
+
+    // Every other row of the scanline pattern is black, drawn over the
+    // image with the scanline intensity as its opacity
+    if(image.scanlines == 0)
+      continue;
+
+    const uInt32 rows = image.scanlineRows;
+    uInt32 alpha;
+    if(image.scanlineSmoothing)
+    {
+      const uInt32 slpos = position(y, rows, sh);
+      const uInt32 r0 = slpos >> 8, r1 = std::min(r0 + 1, rows - 1);
+      alpha = ((r0 & 1) * (256 - (slpos & 0xFF)) + (r1 & 1) * (slpos & 0xFF)) *
+              image.scanlines / 100;
+    }
+    else
+      alpha = (((2 * y + 1) * rows / (2 * sh)) & 1) * image.scanlines * 256 / 100;
+
+    if(alpha > 0)
+      for(uInt32 x = 0; x < sw; ++x)
+        buffer[x] = mix(buffer[x], buffer[x] & 0xFF000000, alpha);
+  }
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 uInt32 TIASurface::pixel(uInt32 idx, uInt8 shift) const
 {
   uInt8 c = *(myTIA->currentFrameBuffer() + idx) | shift;
-  uInt8 p = *(myTIA->previousFrameBuffer() + idx) | shift;
+  if(!myUsePhosphor)
+    return myPalette[c];
 
-  return (!myUsePhosphor ? myPalette[c] : myPhosphorPalette[c][p]);
+  // The image shown is kept at TIA resolution without TV effects only;
+  // otherwise the previous frame is the best there is
+  const uInt32 weight = myPhosphorBlend * 256 / 100;
+  if(!(myFilterType & 0x10))
+  {
+    const uInt32 width = myTIA->width();
+    return blendPixel(myPalette[c], myPhosphorBuffer[
+        idx / width * kPhosphorPitch + idx % width], weight);
+  }
+  uInt8 p = *(myTIA->previousFrameBuffer() + idx) | shift;
+  return blendPixel(myPalette[c], myPalette[p], weight);
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -234,23 +549,16 @@ void TIASurface::enablePhosphor(bool enable, int blend)
   myUsePhosphor   = enable;
   myPhosphorBlend = blend;
   myFilterType = FilterType(enable ? myFilterType | 0x01 : myFilterType & 0x10);
+  myRedrawAll = true;
   myTiaSurface->setDirty();
   mySLineSurface->setDirty();
 }
 
-// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-uInt8 TIASurface::getPhosphor(uInt8 c1, uInt8 c2) const
-{
-  if(c2 > c1)
-    std::swap(c1, c2);
-
-  return ((c1 - c2) * myPhosphorBlend)/100 + c2;
-}
-
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void TIASurface::enableNTSC(bool enable)
 {
   myFilterType = FilterType(enable ? myFilterType | 0x10 : myFilterType & 0x01);
+  myRedrawAll = true;
 
   // Normal vs NTSC mode uses different source widths
   myTiaSurface->setSrcSize(enable ? ATARI_NTSC_OUT_WIDTH(160) : 160, myTIA->height());
@@ -297,72 +605,245 @@ string TIASurface::effectsInfo() const
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void TIASurface::render()
+void TIASurface::expandLine(const uInt8* src, uInt32* dst, uInt32 width) const
 {
-  // Copy the mediasource framebuffer to the RGB texture
-  // In hardware rendering mode, it's faster to just assume that the screen
-  // is dirty and always do an update
-
-  uInt8* currentFrame  = myTIA->currentFrameBuffer();
-  uInt8* previousFrame = myTIA->previousFrameBuffer();
-  uInt32 width         = myTIA->width();
-  uInt32 height        = myTIA->height();
+#if defined(TIASURFACE_AVX2)
+  static const bool avx2 = haveAVX2();
+  if(avx2 && mySIMD)
+    expandLineAVX2(src, dst, width, myPalette);
+  else
+    expandLineScalar(src, dst, width, myPalette);
+#elif defined(TIASURFACE_NEON)
+  if(mySIMD)
+    expandLineNEON(src, dst, width, myPalettePlanes, myPalette);
+  else
+    expandLineScalar(src, dst, width, myPalette);
+#else
+  expandLineScalar(src, dst, width, myPalette);
+#endif
+}
 
-  uInt32 *buffer, pitch;
-  myTiaSurface->basePtr(buffer, pitch);
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void TIASurface::renderLines(const uInt8* pixels, uInt32 width,
+                             uInt32 y, uInt32 h, uInt32* buffer, uInt32 pitch)
+{
+  const uInt8* currentFrame = pixels + y * width;
 
-  // TODO - Eventually 'phosphor' won't be a separate mode, and will become
-  //        a post-processing filter by blending several frames.
+  // Phosphor modes are converted the same way, and blended afterwards
   switch(myFilterType)
   {
     case kNormal:
-    {
-      uInt32 bufofsY    = 0;
-      uInt32 screenofsY = 0;
-      for(uInt32 y = 0; y < height; ++y)
-      {
-        uInt32 pos = screenofsY;
-        for(uInt32 x = 0; x < width; ++x)
-          buffer[pos++] = myPalette[currentFrame[bufofsY + x]];
-
-        bufofsY    += width;
-        screenofsY += pitch;
-      }
-      break;
-    }
     case kPhosphor:
     {
       uInt32 bufofsY    = 0;
       uInt32 screenofsY = 0;
-      for(uInt32 y = 0; y < height; ++y)
+      for(uInt32 line = 0; line < h; ++line)
       {
-        uInt32 pos = screenofsY;
-        for(uInt32 x = 0; x < width; ++x)
-        {
-          const uInt32 bufofs = bufofsY + x;
-          buffer[pos++] = myPhosphorPalette[currentFrame[bufofs]][previousFrame[bufofs]];
-        }
+        expandLine(currentFrame + bufofsY, buffer + screenofsY, width);
+
         bufofsY    += width;
         screenofsY += pitch;
       }
       break;
     }
     case kBlarggNormal:
+    case kBlarggPhosphor:
     {
-      myNTSCFilter.blit_single(currentFrame, width, height,
+      myNTSCFilter.blit_single(const_cast<uInt8*>(currentFrame), width, h,
                                buffer, pitch << 2);
       break;
     }
-    case kBlarggPhosphor:
+  }
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void TIASurface::blendLines(uInt32 tiaWidth, uInt32 y, uInt32 h, bool restart,
+                            uInt32* buffer, uInt32 pitch)
+{
+  const uInt32 width = (myFilterType & 0x10) ?
+      ATARI_NTSC_OUT_WIDTH(tiaWidth) : tiaWidth;
+  const uInt32 weight = myPhosphorBlend * 256 / 100;
+
+  for(uInt32 line = y; line < y + h; ++line)
+  {
+    uInt32* current = buffer + (line - y) * pitch;
+    uInt32* shown   = myPhosphorBuffer.get() + line * kPhosphorPitch;
+
+    if(restart)
     {
-      myNTSCFilter.blit_double(currentFrame, previousFrame, width, height,
-                               buffer, pitch << 2);
-      break;
+      memcpy(shown, current, width * sizeof(uInt32));
+      myFadingLines[line] = false;
     }
+    else
+      myFadingLines[line] = mySIMD ?
+          blendLine(current, shown, width, weight) :
+          blendLineScalar(current, shown, width, weight);
   }
+}
 
-  // Draw TIA image
-  myTiaSurface->setDirty();
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void TIASurface::convertFrame(uInt32* image, uInt32* shown) const
+{
+  const uInt32 width = myTIA->width(), height = myTIA->height();
+  const uInt32 weight = myPhosphorBlend * 256 / 100;
+  const uInt8* pixels = myTIA->currentFrameBuffer();
+
+  for(uInt32 y = 0; y < height; ++y)
+  {
+    const uInt32 offset = y * width;
+    expandLine(pixels + offset, image + offset, width);
+    if(!shown)
+      continue;
+
+    if(mySIMD)
+      blendLine(image + offset, shown + offset, width, weight);
+    else
+      blendLineScalar(image + offset, shown + offset, width, weight);
+  }
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool TIASurface::lineChanged(const Conversion& conv, uInt32 y) const
+{
+  return conv.changed[y] || ((myFilterType & 0x01) && myFadingLines[y]);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void TIASurface::render()
+{
+  if(!myFrameHeld)
+    prepareConversion(myConversion, myTIA->currentFrameBuffer());
+  myFrameHeld = false;
+
+  if(!convertDirect(myConversion))
+    convert(myConversion);
+  draw();
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void TIASurface::holdFrame()
+{
+  memcpy(myHeldFrame.get(), myTIA->currentFrameBuffer(),
+         myTIA->width() * myTIA->height());
+  prepareConversion(myConversion, myHeldFrame.get());
+  myFrameHeld = true;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void TIASurface::prepareConversion(Conversion& conv, const uInt8* pixels)
+{
+  // Only lines that changed since the last render are converted and
+  // uploaded again, unless frames were skipped in between (or settings
+  // were changed), in which case the whole image is converted
+  const uInt32 height = myTIA->height();
+  const uInt32 frame  = myTIA->frameCount();
+
+  conv.pixels    = pixels;
+  conv.width     = myTIA->width();
+  conv.height    = height;
+  conv.restart   = myRedrawAll || height != myLastHeight;
+  conv.redrawAll = conv.restart ||
+      (frame != myLastFrame && frame != myLastFrame + 1);
+  for(uInt32 y = 0; y < height; ++y)
+    conv.changed[y] = myTIA->lineChanged(y);
+
+  myRedrawAll  = false;
+  myLastFrame  = frame;
+  myLastHeight = height;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void TIASurface::convert(const Conversion& conv)
+{
+  // The pixel buffer is out of date after writing to the texture directly
+  const bool redrawAll = conv.redrawAll || myDirectAccess;
+  myDirectAccess = false;
+
+  uInt32 *buffer, pitch;
+  myTiaSurface->basePtr(buffer, pitch);
+
+  for(uInt32 y = 0; y < conv.height; )
+  {
+    if(!redrawAll && !lineChanged(conv, y))
+    {
+      ++y;
+      continue;
+    }
+
+    uInt32 h = 1;
+    while(y + h < conv.height && (redrawAll || lineChanged(conv, y + h)))
+      ++h;
+
+    renderLines(conv.pixels, conv.width, y, h, buffer + y * pitch, pitch);
+    if(myFilterType & 0x01)
+      blendLines(conv.width, y, h, conv.restart, buffer + y * pitch, pitch);
+    myConvertedRows.emplace_back(y, h);
+    y += h;
+  }
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool TIASurface::convertDirect(const Conversion& conv)
+{
+  // Rows converted into the pixel buffer must be uploaded from there first
+  if(!myConvertedRows.empty())
+    return false;
+
+  // The rows locked must be written completely, so everything between the
+  // first and the last changed line is converted
+  uInt32 first = 0, last = conv.height;
+  if(!conv.redrawAll)
+  {
+    while(first < last && !lineChanged(conv, first))
+      ++first;
+    while(last > first && !lineChanged(conv, last - 1))
+      --last;
+  }
+  if(first == last)
+    return true;
+
+  uInt32 *buffer, pitch;
+  if(!myTiaSurface->lockRows(first, last - first, buffer, pitch))
+    return false;
+
+  const uInt32 h = last - first;
+  if(myFilterType & 0x01)
+  {
+    // Texture memory may be write-only, so blending reads from the pixel
+    // buffer instead (which is out of date after this anyway), and only
+    // the result in the phosphor buffer is written to the texture
+    uInt32 *pixels, pixelPitch;
+    myTiaSurface->basePtr(pixels, pixelPitch);
+    pixels += first * pixelPitch;
+
+    renderLines(conv.pixels, conv.width, first, h, pixels, pixelPitch);
+    blendLines(conv.width, first, h, conv.restart, pixels, pixelPitch);
+
+    const uInt32 width = (myFilterType & 0x10) ?
+        ATARI_NTSC_OUT_WIDTH(conv.width) : conv.width;
+    for(uInt32 line = 0; line < h; ++line)
+      memcpy(buffer + line * pitch,
+             myPhosphorBuffer.get() + (first + line) * kPhosphorPitch,
+             width * sizeof(uInt32));
+  }
+  else
+    renderLines(conv.pixels, conv.width, first, h, buffer, pitch);
+  myTiaSurface->unlockRows();
+
+  myDirectAccess = true;
+  return true;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void TIASurface::draw()
+{
+  // Upload the converted rows, and draw the TIA image; this is always done,
+  // even when no lines changed
+  for(const auto& rows: myConvertedRows)
+    myTiaSurface->setDirtyRows(rows.first, rows.second);
+  myConvertedRows.clear();
+
+  myTiaSurface->setDirtyRows(0, 0);
   myTiaSurface->render();
 
   // Draw overlaying scanlines
@@ -25,6 +25,8 @@ class FrameBuffer;
 class FBSurface;
 class VideoMode;
 
+#include <bitset>
+
 #include "Rect.hxx"
 #include "NTSCFilter.hxx"
 #include "bspf.hxx"
@@ -52,15 +54,12 @@ class TIASurface
     void initialize(const Console& console, const VideoMode& mode);
 
     /**
-      Set the palette for TIA rendering.  This currently consists of two
-      components: the actual TIA palette, and a mixed TIA palette used
-      in phosphor mode.  The latter may eventually disappear once a better
-      phosphor emulation is developed.
+      Set the palette for TIA rendering.
 
       @param tia_palette  An actual TIA palette, converted to data values
                           that are actually usable by the framebuffer
-      @param rgb_palette  The RGB components of the palette, needed for
-                          calculating a phosphor palette
+      @param rgb_palette  The RGB components of the palette, needed by
+                          the NTSC filter to calculate its own palette
     */
     void setPalette(const uInt32* tia_palette, const uInt32* rgb_palette);
 
@@ -69,16 +68,50 @@ class TIASurface
     */
     const FBSurface& baseSurface(GUI::Rect& rect);
 
+    /**
+      The TIA image as it's shown, but not scaled to the screen yet, and
+      how it's scaled; used to save snapshots of the screen on another
+      thread (see PNGLibrary).
+    */
+    struct Image {
+      unique_ptr<uInt32[]> pixels;   // width x height pixels
+      uInt32 width, height;
+      uInt32 scaledWidth, scaledHeight;
+      bool smoothing;                // Interpolate while scaling
+      uInt32 scanlines;              // Scanline intensity (0 for none)
+      uInt32 scanlineRows;           // Rows of the scanline pattern shown
+      bool scanlineSmoothing;        // Interpolate the scanline pattern
+    };
+
+    /**
+      Copy the TIA image as it's shown now, with TV effects and phosphor
+      blending, along with the current scaling settings.
+    */
+    void captureImage(Image& image);
+
+    /**
+      Scale an image captured by captureImage() to the size shown, and
+      apply the scanlines, as the framebuffer does when rendering.  This
+      doesn't depend on the TIASurface, so it can be used on any thread.
+
+      @param image   The captured image
+      @param buffer  Filled with scaledWidth x scaledHeight pixels
+    */
+    static void scaleImage(const Image& image, uInt32* buffer);
+
     /**
       Get the TIA pixel associated with the given TIA buffer index,
-      shifting by the given offset (for greyscale values).
+      shifting by the given offset (for greyscale values).  In phosphor
+      mode, it's blended with the image shown so far.
     */
     uInt32 pixel(uInt32 idx, uInt8 shift = 0) const;
 
     /**
-      Get the NTSCFilter object associated with the framebuffer
+      Get the NTSCFilter object associated with the framebuffer.  Changes
+      made through it can't be tracked, so the whole TIA image is
+      converted again at the next render.
     */
-    NTSCFilter& ntsc() { return myNTSCFilter; }
+    NTSCFilter& ntsc() { myRedrawAll = true; return myNTSCFilter; }
 
     /**
       Use NTSC filtering effects specified by the given preset.
@@ -106,19 +139,14 @@ class TIASurface
     void enableScanlineInterpolation(bool enable);
 
     /**
-      Enable/disable phosphor effect.
-    */
-    void enablePhosphor(bool enable, int blend);
-
-    /**
-      Used to calculate an averaged color for the 'phosphor' effect.
-
-      @param c1  Color 1
-      @param c2  Color 2
+      Enable/disable phosphor effect.  Each frame is blended with what was
+      shown before, and the previous image fades out over several frames.
 
-      @return  Averaged value of the two colors
+      @param enable  Whether to enable the phosphor effect
+      @param blend   The percentage of the brighter colour kept when
+                     blending a pixel with the previous image
     */
-    uInt8 getPhosphor(uInt8 c1, uInt8 c2) const;
+    void enablePhosphor(bool enable, int blend);
 
     /**
       Enable/disable/query NTSC filtering effects.
@@ -129,9 +157,115 @@ class TIASurface
 
     /**
       This method should be called to draw the TIA image(s) to the screen.
+      The current TIA frame is drawn, unless one was held before.
     */
     void render();
 
+    /**
+      Copy the current TIA frame, so that the next render() draws it while
+      the TIA already emulates the following frame into its own buffers.
+      Together with those, frames are triple-buffered.
+    */
+    void holdFrame();
+
+    /**
+      Use the vectorized kernels for the current CPU (the default), or the
+      portable ones; both generate the same output.
+    */
+    void enableSIMD(bool enable) { mySIMD = enable; }
+
+    /**
+      Convert the current TIA frame without TV effects into 'image', as
+      normal mode does.  If 'shown' is given, the result is also blended
+      with it as phosphor mode does, and stored in both.  This is the work
+      done per frame in these modes, and is only used for benchmarking the
+      kernels (see enableSIMD()).
+
+      @param image  The converted frame, width x height pixels
+      @param shown  The image shown before, width x height pixels, or nullptr
+    */
+    void convertFrame(uInt32* image, uInt32* shown = nullptr) const;
+
+  private:
+    enum TIAConstants {
+      kTIAW  = 160,
+      kTIAH  = 320,
+      kScanH = kTIAH*2
+    };
+
+    /**
+      The information needed to convert one frame.
+    */
+    struct Conversion {
+      const uInt8* pixels;         // The TIA frame buffer
+      uInt32 width, height;
+      std::bitset<kTIAH> changed;  // Lines which changed since the last frame
+      bool redrawAll;              // Convert all lines, not only changed ones
+      bool restart;                // Don't blend with the phosphor buffer
+    };
+
+    /**
+      Set up the conversion of the current TIA frame from the given pixels.
+    */
+    void prepareConversion(Conversion& conv, const uInt8* pixels);
+
+    /**
+      Convert the changed lines of a frame into the pixel buffer of the
+      TIA surface, and keep track of the rows which must be uploaded at
+      the next draw().
+    */
+    void convert(const Conversion& conv);
+
+    /**
+      Convert the changed lines of a frame directly into the texture of
+      the TIA surface, if it supports that (see FBSurface::lockRows()).
+      The texture is only written to, never read.
+
+      @return  False if the frame must be converted with convert() instead
+    */
+    bool convertDirect(const Conversion& conv);
+
+    /**
+      Draw the TIA surface, as converted so far, and the scanlines.
+    */
+    void draw();
+
+    /**
+      Convert 'h' lines of the TIA image starting at line 'y' into the
+      TIA surface, according to the current filter type.  'buffer' points
+      to line 'y' of the surface, and lines are 'pitch' pixels apart.
+    */
+    void renderLines(const uInt8* pixels, uInt32 width, uInt32 y, uInt32 h,
+                     uInt32* buffer, uInt32 pitch);
+
+    /**
+      Blend 'h' lines of the TIA surface starting at line 'y' with the
+      phosphor buffer, and keep track of the lines which are still fading.
+
+      @param width    The width of the TIA image
+      @param restart  Start over from the current lines, without blending
+      @param buffer   Line 'y' of the TIA surface
+      @param pitch    The number of pixels between lines of the surface
+    */
+    void blendLines(uInt32 width, uInt32 y, uInt32 h, bool restart,
+                    uInt32* buffer, uInt32 pitch);
+
+    /**
+      Answers whether line 'y' of the TIA image must be converted again,
+      since it has changed or is still fading in phosphor mode.
+    */
+    bool lineChanged(const Conversion& conv, uInt32 y) const;
+
+    /**
+      Convert one line of TIA colour indices to pixels using the normal
+      palette.  A vectorized kernel is used when the CPU supports one.
+
+      @param src    The TIA colour indices
+      @param dst    The pixel buffer to fill
+      @param width  The number of pixels in the line
+    */
+    void expandLine(const uInt8* src, uInt32* dst, uInt32 width) const;
+
   private:
     OSystem& myOSystem;
     FrameBuffer& myFB;
@@ -149,12 +283,6 @@ class TIASurface
     };
     FilterType myFilterType;
 
-    enum TIAConstants {
-      kTIAW  = 160,
-      kTIAH  = 320,
-      kScanH = kTIAH*2
-    };
-
     // NTSC object to use in TIA rendering mode
     NTSCFilter myNTSCFilter;
 
@@ -167,11 +295,47 @@ class TIASurface
     // Use scanlines in TIA rendering mode
     bool myScanlinesEnabled;
 
+    // Force conversion of the whole TIA image at the next render, since
+    // settings affecting it were changed
+    bool myRedrawAll;
+
+    // Frame number and height of the TIA image at the last render; lines
+    // of the next frame that didn't change don't need to be converted again
+    uInt32 myLastFrame;
+    uInt32 myLastHeight;
+
     // Palette for normal TIA rendering mode
     const uInt32* myPalette;
 
-    // Palette for phosphor rendering mode
-    uInt32 myPhosphorPalette[256][256];
+    // Use the vectorized kernels, where available
+    bool mySIMD;
+
+  #if defined(__aarch64__) && defined(__ARM_NEON)
+    // Normal palette split into its four byte planes, for NEON table lookups
+    uInt8 myPalettePlanes[4][256];
+  #endif
+
+    // The image shown in phosphor mode, ie. all previous frames blended
+    // together, with one line of the widest (NTSC filtered) image per row
+    enum { kPhosphorPitch = ATARI_NTSC_OUT_WIDTH(kTIAW) };
+    unique_ptr<uInt32[]> myPhosphorBuffer;
+
+    // Lines of the phosphor buffer which haven't settled on the colours
+    // of the current frame yet
+    std::bitset<kTIAH> myFadingLines;
+
+    // Rows of the TIA surface converted since the last draw, as (y, h)
+    vector<std::pair<uInt32, uInt32>> myConvertedRows;
+
+    // The last frame was converted directly into the texture, so the
+    // pixel buffer of the TIA surface is out of date
+    bool myDirectAccess;
+
+    // The conversion of the frame drawn by render(), and the copy of the
+    // TIA frame buffer it uses after holdFrame()
+    Conversion myConversion;
+    unique_ptr<uInt8[]> myHeldFrame;
+    bool myFrameHeld;
 
   private:
     // Following constructors and assignment operators not supported
@@ -68,6 +68,7 @@ MODULE_OBJS := \
 	src/emucore/Paddles.o \
 	src/emucore/Props.o \
 	src/emucore/PropsSet.o \
+	src/emucore/RewindBuffer.o \
 	src/emucore/SaveKey.o \
 	src/emucore/Serializer.o \
 	src/emucore/Settings.o \
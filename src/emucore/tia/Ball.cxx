@@ -207,6 +207,31 @@ void Ball::tick(bool isReceivingMclock)
       myCounter = 0;
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Ball::tickSpan(uInt32 position, uInt32 clocks, uInt64* pixels)
+{
+  const uInt32 end = position + clocks;
+
+  for (uInt32 i = position; i < end; ) {
+    // Nothing is drawn until the counter reaches 156, so the clocks up to
+    // there are counted off at once
+    if (!myIsRendering) {
+      const uInt32 idle = std::min(uInt32((156 + 160 - myCounter) % 160), end - i);
+
+      if (idle > 0) {
+        collision = myCollisionMaskDisabled;
+        myCounter = (myCounter + idle) % 160;
+        i += idle;
+        continue;
+      }
+    }
+
+    tick();
+    pixels[i >> 6] |= uInt64(collision >> 15) << (i & 63);
+    i++;
+  }
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Ball::setENABLOld(bool enabled)
 {
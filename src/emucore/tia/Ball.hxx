@@ -61,11 +61,14 @@ class Ball : public Serializable
     bool movementTick(uInt32 clock, bool apply);
 
     void tick(bool isReceivingMclock = true);
+    void tickSpan(uInt32 position, uInt32 clocks, uInt64* pixels);
 
     uInt8 getPixel(uInt8 colorIn) const {
       return (collision & 0x8000) ? myColor : colorIn;
     }
 
+    uInt8 getColor() const { return myColor; }
+
     void shuffleStatus();
 
     uInt8 getPosition() const;
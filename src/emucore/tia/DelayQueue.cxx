@@ -19,8 +19,13 @@
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 DelayQueue::DelayQueue(uInt8 length, uInt8 size)
-  : myIndex(0)
+  : myLength(length),
+    myIndex(0),
+    myPending(0)
 {
+  if (length > 32)
+    throw runtime_error("delay queue length exceeds 32");
+
   myMembers.reserve(length);
 
   for (uInt16 i = 0; i < length; i++)
@@ -32,28 +37,53 @@ DelayQueue::DelayQueue(uInt8 length, uInt8 size)
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void DelayQueue::push(uInt8 address, uInt8 value, uInt8 delay)
 {
-  uInt8 length = myMembers.size();
-
-  if (delay >= length)
+  if (delay >= myLength)
     throw runtime_error("delay exceeds queue length");
 
   uInt8 currentIndex = myIndices[address];
 
-  if (currentIndex < 0xFF)
-    myMembers.at(currentIndex).remove(address);
+  if (currentIndex < 0xFF) {
+    DelayQueueMember& member = myMembers[currentIndex];
+
+    member.remove(address);
+    if (member.isEmpty()) myPending &= ~(1u << currentIndex);
+  }
 
-  uInt8 index = (myIndex + delay) % length;
-  myMembers.at(index).push(address, value);
+  uInt8 index = myIndex + delay;
+  if (index >= myLength) index -= myLength;
+
+  myMembers[index].push(address, value);
+  myPending |= 1u << index;
 
   myIndices[address] = index;
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+uInt32 DelayQueue::idleClocks(uInt32 maxClocks) const
+{
+  if (!myPending) return maxClocks;
+
+  // Rotate the pending slots so that bit 0 is the current one; the first
+  // set bit is then the next write
+  uInt64 pending = uInt64(myPending) | (uInt64(myPending) << myLength);
+  pending >>= myIndex;
+
+  uInt32 clocks = 0;
+  while (clocks < maxClocks && !(pending & 1)) {
+    pending >>= 1;
+    clocks++;
+  }
+
+  return clocks;
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void DelayQueue::reset()
 {
   for (DelayQueueMember& member : myMembers)
     member.clear();
 
+  myPending = 0;
   memset(myIndices, 0xFF, 0xFF);
 }
 
@@ -62,7 +92,7 @@ bool DelayQueue::save(Serializer& out) const
 {
   try
   {
-    out.putInt(uInt32(myMembers.size()));
+    out.putInt(myLength);
     for(const DelayQueueMember& m: myMembers)
       m.save(out);
 
@@ -83,9 +113,16 @@ bool DelayQueue::load(Serializer& in)
 {
   try
   {
-    myMembers.resize(in.getInt());
-    for(DelayQueueMember& m: myMembers)
-      m.load(in);
+    if(in.getInt() != myLength)
+      throw runtime_error("delay queue length mismatch");
+
+    myPending = 0;
+    for(uInt8 i = 0; i < myLength; ++i)
+    {
+      myMembers[i].load(in);
+      if(!myMembers[i].isEmpty())
+        myPending |= 1u << i;
+    }
 
     myIndex = in.getByte();
     in.getByteArray(myIndices, 0xFF);
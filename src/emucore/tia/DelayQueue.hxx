@@ -38,6 +38,20 @@ class DelayQueue : public Serializable
 
     template<class T> void execute(T executor);
 
+    /**
+      Count the clocks (up to 'maxClocks') that can pass before a write
+      falls due; 0 means that the next execute() will perform a write.
+    */
+    uInt32 idleClocks(uInt32 maxClocks) const;
+
+    /**
+      Advance the queue by the given number of clocks, which must all be
+      idle (see above).
+    */
+    void skip(uInt32 clocks) {
+      myIndex = (myIndex + clocks) % myLength;
+    }
+
     /**
       Serializable methods (see that class for more information).
     */
@@ -46,8 +60,13 @@ class DelayQueue : public Serializable
     string name() const override { return "TIA_DelayQueue"; }
 
   private:
+    // The queue is a ring of 'myLength' slots (at most 32), one of which is
+    // executed on each clock; 'myPending' has a bit set for each slot that
+    // contains at least one write, so empty slots can be passed over quickly
     vector<DelayQueueMember> myMembers;
+    uInt8 myLength;
     uInt8 myIndex;
+    uInt32 myPending;
     uInt8 myIndices[0xFF];
 
   private:
@@ -64,16 +83,19 @@ class DelayQueue : public Serializable
 
 template<class T> void DelayQueue::execute(T executor)
 {
-  DelayQueueMember& currentMember = myMembers.at(myIndex);
+  if (myPending & (1u << myIndex)) {
+    DelayQueueMember& currentMember = myMembers[myIndex];
 
-  for (auto&& entry : currentMember) {
-    executor(entry.address, entry.value);
-    myIndices[entry.address] = 0xFF;
-  }
+    for (auto&& entry : currentMember) {
+      executor(entry.address, entry.value);
+      myIndices[entry.address] = 0xFF;
+    }
 
-  currentMember.clear();
+    currentMember.clear();
+    myPending &= ~(1u << myIndex);
+  }
 
-  myIndex = (myIndex + 1) % myMembers.size();
+  if (++myIndex >= myLength) myIndex = 0;
 }
 
 #endif //  TIA_DELAY_QUEUE
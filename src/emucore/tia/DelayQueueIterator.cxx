@@ -36,7 +36,7 @@ DelayQueueIterator::DelayQueueIterator(const DelayQueue& delayQueue)
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 bool DelayQueueIterator::isValid() const
 {
-  return myDelayCycle < myDelayQueue.myMembers.size();
+  return myDelayCycle < myDelayQueue.myLength;
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -39,7 +39,7 @@ class DelayQueueIterator
 
   private:
     uInt8 currentIndex() const {
-      return (myDelayQueue.myIndex +  myDelayCycle) % myDelayQueue.myMembers.size();
+      return (myDelayQueue.myIndex +  myDelayCycle) % myDelayQueue.myLength;
     }
 
   private:
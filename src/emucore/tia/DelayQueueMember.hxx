@@ -57,6 +57,10 @@ class DelayQueueMember : public Serializable
       mySize = 0;
     }
 
+    bool isEmpty() const {
+      return mySize == 0;
+    }
+
     /**
       Serializable methods (see that class for more information).
     */
@@ -35,6 +35,17 @@ DrawCounterDecodes& DrawCounterDecodes::DrawCounterDecodes::get()
   return myInstance;
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+uInt32 DrawCounterDecodes::clocksToDecode(const uInt8* decodes, uInt8 counter)
+{
+  uInt32 clocks = 160;
+
+  for (uInt32 position : {12, 28, 60, 156})
+    if (decodes[position]) clocks = std::min(clocks, (position + 160 - counter) % 160);
+
+  return clocks;
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 DrawCounterDecodes::DrawCounterDecodes()
 {
@@ -30,6 +30,9 @@ class DrawCounterDecodes
 
     static DrawCounterDecodes& get();
 
+    // Number of clocks until the counter reaches the next decode
+    static uInt32 clocksToDecode(const uInt8* decodes, uInt8 counter);
+
   protected:
 
     DrawCounterDecodes();
@@ -210,6 +210,32 @@ void Missile::tick(uInt8 hclock)
   if (++myCounter >= 160) myCounter = 0;
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Missile::tickSpan(uInt8 hclock, uInt32 clocks, uInt64* pixels)
+{
+  const uInt32 end = hclock + clocks;
+
+  for (uInt32 i = hclock; i < end; ) {
+    // Nothing is drawn until the counter reaches the next copy (never
+    // while RESMP is set), so the clocks up to there are counted off at once
+    if (!myIsRendering) {
+      const uInt32 idle = myResmp ? end - i :
+        std::min(DrawCounterDecodes::clocksToDecode(myDecodes, myCounter), end - i);
+
+      if (idle > 0) {
+        collision = myCollisionMaskDisabled;
+        myCounter = (myCounter + idle) % 160;
+        i += idle;
+        continue;
+      }
+    }
+
+    tick(i);
+    pixels[i >> 6] |= uInt64(collision >> 15) << (i & 63);
+    i++;
+  }
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Missile::setColor(uInt8 color)
 {
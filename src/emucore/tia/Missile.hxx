@@ -51,6 +51,7 @@ class Missile : public Serializable
     bool movementTick(uInt8 clock, uInt8 hclock, bool apply);
 
     void tick(uInt8 hclock);
+    void tickSpan(uInt8 hclock, uInt32 clocks, uInt64* pixels);
 
     void setColor(uInt8 color);
 
@@ -67,6 +68,8 @@ class Missile : public Serializable
       return (collision & 0x8000) ? myColor : colorIn;
     }
 
+    uInt8 getColor() const { return myColor; }
+
     uInt8 getPosition() const;
     void setPosition(uInt8 newPosition);
 
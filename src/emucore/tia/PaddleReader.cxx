@@ -16,6 +16,7 @@
 //============================================================================
 
 #include <cmath>
+#include <limits>
 
 #include "PaddleReader.hxx"
 
@@ -34,52 +35,52 @@ PaddleReader::PaddleReader()
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void PaddleReader::reset(double timestamp)
+void PaddleReader::reset(uInt64 timestamp)
 {
-  myU = 0;
+  myCharge = 0;
   myIsDumped = false;
 
-  myValue = 0;
+  myValue = -1;
+  myHasValue = false;
   myTimestamp = timestamp;
 
   setLayout(FrameLayout::ntsc);
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void PaddleReader::vblank(uInt8 value, double timestamp)
+void PaddleReader::vblank(uInt8 value, uInt64 timestamp)
 {
   bool oldIsDumped = myIsDumped;
 
   if (value & 0x80) {
     myIsDumped = true;
-    myU = 0;
+    myCharge = 0;
     myTimestamp = timestamp;
   } else if (oldIsDumped) {
     myIsDumped = false;
     myTimestamp = timestamp;
+    updateDeadline();
   }
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-uInt8 PaddleReader::inpt(double timestamp)
-{
-  updateCharge(timestamp);
-
-  bool state = myIsDumped ? false : myU > myUThresh;
-
-  return state ? 0x80 : 0;
-}
-
-// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void PaddleReader::update(double value, double timestamp, FrameLayout layout)
+void PaddleReader::update(double value, uInt64 timestamp, FrameLayout layout)
 {
   if (layout != myLayout) {
     setLayout(layout);
   }
 
-  if (value != myValue) {
+  if (!myHasValue) {
     myValue = value;
+    myHasValue = true;
+    updateDeadline();
+  }
+
+  // The charge up to now builds up with the old resistance
+  if (value != myValue) {
     updateCharge(timestamp);
+    myValue = value;
+    updateDeadline();
   }
 }
 
@@ -89,19 +90,40 @@ void PaddleReader::setLayout(FrameLayout layout)
   myLayout = layout;
 
   myClockFreq = myLayout == FrameLayout::ntsc ? 60 * 228 * 262 : 50 * 228 * 312;
-  myUThresh = USUPP * (1. - exp(-TRIPPOINT_LINES * 228 / myClockFreq  / (RPOT + R0) / C));
+  myTripCharge = TRIPPOINT_LINES * 228 / myClockFreq  / (RPOT + R0) / C;
+
+  updateDeadline();
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void PaddleReader::updateCharge(double timestamp)
+void PaddleReader::updateCharge(uInt64 timestamp)
 {
   if (myIsDumped) return;
 
-  if (myValue >= 0)
-    myU = USUPP * (1 - (1 - myU / USUPP) *
-      exp(-(timestamp - myTimestamp) / (myValue * RPOT + R0) / C / myClockFreq));
+  // Time never runs backwards here, even if the timestamp was reset
+  if (myValue >= 0 && timestamp > myTimestamp)
+    myCharge += (timestamp - myTimestamp) / ((myValue * RPOT + R0) * C * myClockFreq);
 
   myTimestamp = timestamp;
+
+  updateDeadline();
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void PaddleReader::updateDeadline()
+{
+  // The input trips on the first clock on which the charge exceeds the
+  // trip point; with maximum resistance, the charge doesn't change at all
+  const double deadline = myValue >= 0 ?
+    myTimestamp + (myTripCharge - myCharge) * (myValue * RPOT + R0) * C * myClockFreq :
+    (myCharge > myTripCharge ? 0 : HUGE_VAL);
+
+  if (deadline <= 0)
+    myDeadline = 0;
+  else if (deadline >= double(std::numeric_limits<uInt64>::max()))
+    myDeadline = std::numeric_limits<uInt64>::max();
+  else
+    myDeadline = uInt64(deadline);
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -111,11 +133,12 @@ bool PaddleReader::save(Serializer& out) const
   {
     out.putString(name());
 
-    out.putDouble(myUThresh);
-    out.putDouble(myU);
+    // Stored as voltages, as in older states
+    out.putDouble(USUPP * -expm1(-myTripCharge));
+    out.putDouble(USUPP * -expm1(-myCharge));
 
     out.putDouble(myValue);
-    out.putDouble(myTimestamp);
+    out.putDouble(double(myTimestamp));
 
     out.putInt(int(myLayout));
     out.putDouble(myClockFreq);
@@ -139,16 +162,19 @@ bool PaddleReader::load(Serializer& in)
     if(in.getString() != name())
       return false;
 
-    myUThresh = in.getDouble();
-    myU = in.getDouble();
+    myTripCharge = -log1p(-in.getDouble() / USUPP);
+    myCharge = -log1p(-in.getDouble() / USUPP);
 
     myValue = in.getDouble();
-    myTimestamp = in.getDouble();
+    myHasValue = true;
+    myTimestamp = uInt64(in.getDouble());
 
     myLayout = FrameLayout(in.getInt());
     myClockFreq = in.getDouble();
 
     myIsDumped = in.getBool();
+
+    updateDeadline();
   }
   catch(...)
   {
@@ -30,14 +30,16 @@ class PaddleReader : public Serializable
 
   public:
 
-    void reset(double timestamp);
+    void reset(uInt64 timestamp);
 
-    void vblank(uInt8 value, double timestamp);
+    void vblank(uInt8 value, uInt64 timestamp);
     bool vblankDumped() const { return myIsDumped; }
 
-    uInt8 inpt(double timestamp);
+    uInt8 inpt(uInt64 timestamp) const {
+      return (!myIsDumped && timestamp > myDeadline) ? 0x80 : 0;
+    }
 
-    void update(double value, double timestamp, FrameLayout layout);
+    void update(double value, uInt64 timestamp, FrameLayout layout);
 
     /**
       Serializable methods (see that class for more information).
@@ -50,15 +52,25 @@ class PaddleReader : public Serializable
 
     void setLayout(FrameLayout layout);
 
-    void updateCharge(double timestamp);
+    void updateCharge(uInt64 timestamp);
+
+    void updateDeadline();
 
   private:
 
-    double myUThresh;
-    double myU;
+    // The charge of the capacitor is kept as -ln(1 - U / USUPP), which
+    // grows linearly with time; the input trips once it exceeds the
+    // corresponding value of the threshold voltage, so the clock at which
+    // this happens can be computed in advance
+    double myTripCharge;
+    double myCharge;
 
+    // Until the controller is read for the first time after a reset, its
+    // value isn't known; that first value then counts from the reset on
     double myValue;
-    double myTimestamp;
+    bool myHasValue;
+    uInt64 myTimestamp;
+    uInt64 myDeadline;
 
     FrameLayout myLayout;
     double myClockFreq;
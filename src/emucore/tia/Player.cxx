@@ -309,6 +309,32 @@ void Player::tick()
   if (++myCounter >= 160) myCounter = 0;
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Player::tickSpan(uInt32 position, uInt32 clocks, uInt64* pixels)
+{
+  const uInt32 end = position + clocks;
+
+  for (uInt32 i = position; i < end; ) {
+    // Nothing is drawn until the counter reaches the next copy, so the
+    // clocks up to there are counted off at once
+    if (!myIsRendering) {
+      const uInt32 idle =
+        std::min(DrawCounterDecodes::clocksToDecode(myDecodes, myCounter), end - i);
+
+      if (idle > 0) {
+        collision = myCollisionMaskDisabled;
+        myCounter = (myCounter + idle) % 160;
+        i += idle;
+        continue;
+      }
+    }
+
+    tick();
+    pixels[i >> 6] |= uInt64(collision >> 15) << (i & 63);
+    i++;
+  }
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Player::shufflePatterns()
 {
@@ -62,8 +62,11 @@ class Player : public Serializable
     bool movementTick(uInt32 clock, bool apply);
 
     void tick();
+    void tickSpan(uInt32 position, uInt32 clocks, uInt64* pixels);
     uInt8 getClock() const { return myCounter; }
 
+    uInt8 getColor() const { return myColor; }
+
     uInt8 getPixel(uInt8 colorIn) const {
       return (collision & 0x8000) ? myColor : colorIn;
     }
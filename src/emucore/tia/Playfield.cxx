@@ -199,6 +199,30 @@ void Playfield::tick(uInt32 x)
   collision = currentPixel ? myCollisionMaskEnabled : myCollisionMaskDisabled;
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Playfield::tickSpan(uInt32 x, uInt32 position, uInt32 clocks, uInt64* pixels)
+{
+  // The pattern only changes every four clocks, so each of these runs is
+  // set in one go
+  for (uInt32 i = 0; i < clocks; ) {
+    const uInt32 run = std::min(4 - ((x + i) & 0x03), clocks - i);
+
+    tick(x + i);
+
+    if (collision & 0x8000) {
+      const uInt32 p = position + i;
+      const uInt64 bits = (uInt64(1) << run) - 1;
+
+      pixels[p >> 6] |= bits << (p & 63);
+      if ((p & 63) + run > 64) pixels[(p >> 6) + 1] |= bits >> (64 - (p & 63));
+    }
+
+    i += run;
+  }
+
+  myX = x + clocks - 1;
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Playfield::applyColors()
 {
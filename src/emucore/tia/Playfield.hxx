@@ -58,12 +58,16 @@ class Playfield : public Serializable
     void applyColorLoss();
 
     void tick(uInt32 x);
+    void tickSpan(uInt32 x, uInt32 position, uInt32 clocks, uInt64* pixels);
 
     uInt8 getPixel(uInt8 colorIn) const {
       if (collision & 0x8000) return myX < 80 ? myColorLeft : myColorRight;
       return colorIn;
     }
 
+    uInt8 getColorLeft() const { return myColorLeft; }
+    uInt8 getColorRight() const { return myColorRight; }
+
     /**
       Serializable methods (see that class for more information).
     */
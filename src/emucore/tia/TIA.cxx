@@ -20,11 +20,18 @@
 #include "Console.hxx"
 #include "Control.hxx"
 #include "Paddles.hxx"
+#include "MovieRecorder.hxx"
 
 #ifdef DEBUGGER_SUPPORT
   #include "CartDebug.hxx"
 #endif
 
+#if defined(__SSE2__)
+  #include <emmintrin.h>
+#elif defined(__ARM_NEON)
+  #include <arm_neon.h>
+#endif
+
 enum CollisionMask: uInt32 {
   player0   = 0b0111110000000000,
   player1   = 0b0100001111000000,
@@ -61,6 +68,18 @@ enum ResxCounter: uInt8 {
 // 70, the G.I. Joe will show an artifact (hole in roof).
 static constexpr uInt8 resxLateHblankThreshold = 73;
 
+// Get the 16 pixels of an object starting at the given position
+static inline uInt32 pixelBits(const uInt64* pixels, uInt32 position)
+{
+  const uInt32 shift = position & 63;
+  uInt64 bits = pixels[position >> 6] >> shift;
+
+  if (shift > 48)
+    bits |= pixels[(position >> 6) + 1] << (64 - shift);
+
+  return uInt32(bits) & 0xFFFF;
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 TIA::TIA(Console& console, Sound& sound, Settings& settings)
   : myConsole(console),
@@ -74,7 +93,9 @@ TIA::TIA(Console& console, Sound& sound, Settings& settings)
     myPlayer1(~CollisionMask::player1 & 0x7FFF),
     myBall(~CollisionMask::ball & 0x7FFF),
     mySpriteEnabledBits(0xFF),
-    myCollisionsEnabledBits(0xFF)
+    myCollisionsEnabledBits(0xFF),
+    myDrawingEnabled(true),
+    myRecorder(nullptr)
 {
   myFrameManager.setHandlers(
     [this] () {
@@ -115,6 +136,7 @@ void TIA::reset()
   myPriority = Priority::normal;
   myHstate = HState::blank;
   myCollisionMask = 0;
+  clearPixels();
   myLinesSinceChange = 0;
   myCollisionUpdateRequired = false;
   myAutoFrameEnabled = false;
@@ -122,6 +144,7 @@ void TIA::reset()
   myColorHBlank = 0;
   myLastCycle = 0;
   mySubClock = 0;
+  myIdleCyclesLastFrame = 0;
   myXDelta = 0;
 
   memset(myShadowRegisters, 0, 64);
@@ -193,6 +216,20 @@ void TIA::clearBuffers()
 {
   memset(myCurrentFrameBuffer.get(), 0, 160 * FrameManager::frameBufferHeight);
   memset(myPreviousFrameBuffer.get(), 0, 160 * FrameManager::frameBufferHeight);
+
+  // Nothing is known about what was shown before
+  memset(myCurrentChangedLines, 0xff, sizeof(myCurrentChangedLines));
+  memset(myPreviousChangedLines, 0xff, sizeof(myPreviousChangedLines));
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool TIA::frameChanged() const
+{
+  for(uInt32 i = 0; i < changedLineWords; ++i)
+    if(myCurrentChangedLines[i])
+      return true;
+
+  return false;
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -230,7 +267,7 @@ bool TIA::save(Serializer& out) const
     out.putInt(myXDelta);
 
     out.putBool(myCollisionUpdateRequired);
-    out.putInt(myCollisionMask);
+    out.putInt(collisionMask());
 
     out.putInt(myMovementClock);
     out.putBool(myMovementInProgress);
@@ -248,7 +285,7 @@ bool TIA::save(Serializer& out) const
 
     out.putByte(myColorHBlank);
 
-    out.putDouble(myTimestamp);
+    out.putDouble(double(myTimestamp));
 
     out.putBool(myAutoFrameEnabled);
 
@@ -300,6 +337,7 @@ bool TIA::load(Serializer& in)
 
     myCollisionUpdateRequired = in.getBool();
     myCollisionMask = in.getInt();
+    clearPixels();
 
     myMovementClock = in.getInt();
     myMovementInProgress = in.getBool();
@@ -317,7 +355,7 @@ bool TIA::load(Serializer& in)
 
     myColorHBlank = in.getByte();
 
-    myTimestamp = in.getDouble();
+    myTimestamp = uInt64(in.getDouble());
 
     myAutoFrameEnabled = in.getBool();
 
@@ -466,27 +504,14 @@ bool TIA::poke(uInt16 address, uInt8 value)
     ////////////////////////////////////////////////////////////
     // FIXME - rework this when we add the new sound core
     case AUDV0:
-      mySound.set(address, value, mySystem->cycles());
-      myShadowRegisters[address] = value;
-      break;
     case AUDV1:
-      mySound.set(address, value, mySystem->cycles());
-      myShadowRegisters[address] = value;
-      break;
     case AUDF0:
-      mySound.set(address, value, mySystem->cycles());
-      myShadowRegisters[address] = value;
-      break;
     case AUDF1:
-      mySound.set(address, value, mySystem->cycles());
-      myShadowRegisters[address] = value;
-      break;
     case AUDC0:
-      mySound.set(address, value, mySystem->cycles());
-      myShadowRegisters[address] = value;
-      break;
     case AUDC1:
       mySound.set(address, value, mySystem->cycles());
+      if(myRecorder)
+        myRecorder->audioWrite(address, value, mySystem->cycles());
       myShadowRegisters[address] = value;
       break;
     ////////////////////////////////////////////////////////////
@@ -707,6 +732,7 @@ bool TIA::poke(uInt16 address, uInt8 value)
     case CXCLR:
       flushLineCache();
       myCollisionMask = 0;
+      clearPixels();
       myShadowRegisters[address] = value;
       break;
   }
@@ -851,6 +877,8 @@ bool TIA::toggleCollision(TIABit b, uInt8 mode)
       break;
   }
 
+  // Pixels collected so far still count with the old settings
+  updateCollision();
   myCollisionsEnabledBits = (myCollisionsEnabledBits & ~b) | mask;
 
   myMissile0.toggleCollisions(myCollisionsEnabledBits & TIABit::M0Bit);
@@ -991,6 +1019,7 @@ void TIA::updateEmulation()
 void TIA::swapBuffers()
 {
   myCurrentFrameBuffer.swap(myPreviousFrameBuffer);
+  std::swap(myCurrentChangedLines, myPreviousChangedLines);
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -1000,8 +1029,10 @@ void TIA::onFrameStart()
 
   const Int32 x = myHctr - 68;
 
-  if (x > 0)
+  if (x > 0) {
     memset(myCurrentFrameBuffer.get(), 0, x);
+    markLineChanged(0);
+  }
 
   for (uInt8 i = 0; i < 4; i++)
     updatePaddle(i);
@@ -1029,14 +1060,24 @@ void TIA::onFrameStart()
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void TIA::onFrameComplete()
 {
+  const uInt32 cycles = mySystem->cycles();
+
   mySystem->m6502().stop();
   mySystem->resetCycles();
 
+  myIdleCyclesLastFrame = mySystem->m6502().skippedCycles();
+  mySystem->m6502().clearSkippedCycles();
+
   // Blank out any extra lines not drawn this frame
   const uInt32 missingScanlines = myFrameManager.missingScanlines();
   if (missingScanlines > 0)
     memset(myCurrentFrameBuffer.get() + 160 * myFrameManager.getY(), 0, missingScanlines * 160);
 
+  updateChangedLines();
+
+  if(myRecorder)
+    myRecorder->frameComplete(cycles);
+
   // Recalculate framerate, attempting to auto-correct for scanline 'jumps'
   if(myAutoFrameEnabled)
     myConsole.setFramerate(myFrameManager.frameRate());
@@ -1045,8 +1086,16 @@ void TIA::onFrameComplete()
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void TIA::cycle(uInt32 colorClocks)
 {
-  for (uInt32 i = 0; i < colorClocks; i++)
+  while (colorClocks > 0)
   {
+    uInt32 clocks = skipIdleClocks(colorClocks);
+    if (clocks == 0) clocks = tickHframeSpan(colorClocks);
+
+    if (clocks > 0) {
+      colorClocks -= clocks;
+      continue;
+    }
+
     myDelayQueue.execute(
       [this] (uInt8 address, uInt8 value) {delayedWrite(address, value);}
     );
@@ -1061,13 +1110,188 @@ void TIA::cycle(uInt32 colorClocks)
       else
         tickHframe();
 
-      if (myCollisionUpdateRequired) updateCollision();
+      if (myCollisionUpdateRequired) updateCollisionClock();
     }
 
     if (++myHctr >= 228)
       nextLine();
 
     myTimestamp++;
+    colorClocks--;
+  }
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+uInt32 TIA::skipIdleClocks(uInt32 maxClocks)
+{
+  // While the line cache is active, or during HBLANK without HMOVE in
+  // progress, nothing happens on a clock besides counting; the next events
+  // are a delayed write falling due, the end of HBLANK or the end of the
+  // line.  Everything up to the first of these is done in one step.
+  const bool lineCache = myLinesSinceChange >= 2;
+
+  if (!lineCache && (myHstate != HState::blank || myMovementInProgress))
+    return 0;
+
+  uInt32 clocks = std::min(maxClocks, uInt32(228 - myHctr));
+
+  if (!lineCache) {
+    if (myHctr == 0) myHblankCtr = 0;
+    if (myHblankCtr >= 68) return 0;
+
+    clocks = std::min(clocks, uInt32(68 - myHblankCtr));
+  }
+
+  clocks = myDelayQueue.idleClocks(clocks);
+  if (clocks == 0) return 0;
+
+  myDelayQueue.skip(clocks);
+  myCollisionUpdateRequired = false;
+
+  if (!lineCache && (myHblankCtr += clocks) >= 68)
+    myHstate = HState::frame;
+
+  // The timestamp of the last clock is only advanced after the line is
+  // finished, as in cycle()
+  myTimestamp += clocks - 1;
+
+  if ((myHctr += clocks) >= 228)
+    nextLine();
+
+  myTimestamp++;
+
+  return clocks;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+uInt32 TIA::tickHframeSpan(uInt32 maxClocks)
+{
+  // Outside the line cache and without HMOVE in progress, the objects are
+  // independent of each other until the next write falls due or the line
+  // ends.  Up to that point, each object is ticked through the whole span
+  // at once, and the pixels are then combined for all clocks together.
+  // Anything else takes the regular per-clock path.
+  if (myLinesSinceChange >= 2 || myHstate != HState::frame || myMovementInProgress)
+    return 0;
+
+  const uInt32 clocks =
+    myDelayQueue.idleClocks(std::min(maxClocks, uInt32(228 - myHctr)));
+
+  // Not worth it for very short spans
+  if (clocks < 4) return 0;
+
+  const uInt32 x = myHctr - 68 - myXDelta;
+  myPlayfield.tickSpan(x, myHctr, clocks, myObjectPixels[0]);
+  myMissile0.tickSpan(myHctr, clocks, myObjectPixels[1]);
+  myMissile1.tickSpan(myHctr, clocks, myObjectPixels[2]);
+  myPlayer0.tickSpan(myHctr, clocks, myObjectPixels[3]);
+  myPlayer1.tickSpan(myHctr, clocks, myObjectPixels[4]);
+  myBall.tickSpan(myHctr, clocks, myObjectPixels[5]);
+
+  myCollisionPending = true;
+
+  if (isDrawing())
+    renderSpan(x, clocks);
+
+  // Leave everything as the last clock of cycle() would have
+  myDelayQueue.skip(clocks);
+  myCollisionUpdateRequired = true;
+  myTimestamp += clocks - 1;
+
+  if ((myHctr += clocks) >= 228)
+    nextLine();
+
+  myTimestamp++;
+
+  return clocks;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void TIA::renderSpan(Int32 x, uInt32 clocks)
+{
+  // This is renderPixel() for a span of clocks starting at 'x', using the
+  // pixels collected for each object; only x = 0 .. 159 are actually drawn
+  const uInt32 begin = std::min(uInt32(std::max(-x, 0)), clocks);
+  const uInt32 end = std::min(uInt32(std::max(160 - x, 0)), clocks);
+
+  if (begin >= end) return;
+
+  uInt8* buffer = myCurrentFrameBuffer.get() + myFrameManager.getY() * 160;
+
+  if (myFrameManager.vblank()) {
+    memset(buffer + x + begin, 0, end - begin);
+    return;
+  }
+
+  // Objects in order of increasing priority (see renderPixel()); the
+  // playfield (index 0) has a different colour in each half of the screen,
+  // so each half is drawn separately
+  static constexpr uInt8 order[3][6] = {
+    {2, 4, 1, 3, 0, 5},  // pfp:    BL/PF => P0/M0 => P1/M1 => BK
+    {5, 2, 4, 0, 1, 3},  // score:  PF/P0/M0 => P1/M1 => BL => BK
+    {0, 5, 2, 4, 1, 3}   // normal: P0/M0 => P1/M1 => BL/PF => BK
+  };
+  uInt8 colors[6] = {
+    myPlayfield.getColorLeft(), myMissile0.getColor(), myMissile1.getColor(),
+    myPlayer0.getColor(), myPlayer1.getColor(), myBall.getColor()
+  };
+  const uInt8* layerOrder = order[myPriority];
+  const uInt8 bk = myBackground.getColor();
+
+  const uInt32 half = std::min(std::max(uInt32(std::max(80 - x, 0)), begin), end);
+
+  for (uInt32 i = begin; i < end; ) {
+    const uInt32 last = i < half ? half : end;
+    if (i == half) colors[0] = myPlayfield.getColorRight();
+
+#if defined(__SSE2__)
+    const __m128i select = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+    for (; i + 16 <= last; i += 16) {
+      __m128i color = _mm_set1_epi8(bk);
+
+      for (uInt32 l = 0; l < 6; l++) {
+        const uInt8 layer = layerOrder[l];
+
+        // Spread the 16 pixel bits over the 16 bytes
+        __m128i on = _mm_cvtsi32_si128(pixelBits(myObjectPixels[layer], myHctr + i));
+        on = _mm_unpacklo_epi8(on, on);
+        on = _mm_unpacklo_epi16(on, on);
+        on = _mm_unpacklo_epi32(on, on);
+        on = _mm_cmpeq_epi8(_mm_and_si128(on, select), select);
+
+        color = _mm_or_si128(_mm_and_si128(on, _mm_set1_epi8(colors[layer])), _mm_andnot_si128(on, color));
+      }
+
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(buffer + x + i), color);
+    }
+#elif defined(__ARM_NEON)
+    const uint8x16_t select = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+    for (; i + 16 <= last; i += 16) {
+      uint8x16_t color = vdupq_n_u8(bk);
+
+      for (uInt32 l = 0; l < 6; l++) {
+        const uInt8 layer = layerOrder[l];
+        const uInt32 bits = pixelBits(myObjectPixels[layer], myHctr + i);
+        const uint8x16_t on = vtstq_u8(vcombine_u8(vdup_n_u8(bits), vdup_n_u8(bits >> 8)), select);
+
+        color = vbslq_u8(on, vdupq_n_u8(colors[layer]), color);
+      }
+
+      vst1q_u8(buffer + x + i, color);
+    }
+#endif
+    for (; i < last; i++) {
+      const uInt32 position = myHctr + i;
+      uInt8 color = bk;
+
+      for (uInt32 l = 0; l < 6; l++) {
+        const uInt8 layer = layerOrder[l];
+        if ((myObjectPixels[layer][position >> 6] >> (position & 63)) & 1)
+          color = colors[layer];
+      }
+
+      buffer[x + i] = color;
+    }
   }
 }
 
@@ -1119,7 +1343,7 @@ void TIA::tickHframe()
   myPlayer1.tick();
   myBall.tick();
 
-  if (myFrameManager.isRendering())
+  if (isDrawing())
     renderPixel(x, y);
 }
 
@@ -1128,8 +1352,11 @@ void TIA::applyRsync()
 {
   const uInt32 x = myHctr > 68 ? myHctr - 68 : 0;
 
+  // The remaining clocks of the line are emulated again
+  updateCollision();
+
   myXDelta = 157 - x;
-  if (myFrameManager.isRendering())
+  if (isDrawing())
     memset(myCurrentFrameBuffer.get() + myFrameManager.getY() * 160 + x, 0, 160 - x);
 
   myHctr = 225;
@@ -1138,6 +1365,8 @@ void TIA::applyRsync()
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void TIA::nextLine()
 {
+  updateCollision();
+
   if (myLinesSinceChange >= 2) {
     cloneLastLine();
   }
@@ -1153,6 +1382,33 @@ void TIA::nextLine()
   myFrameManager.nextLine();
 
   if (myFrameManager.isRendering() && myFrameManager.getY() == 0) flushLineCache();
+
+  // The line is about to be drawn; it is compared with the previous frame
+  // only once the frame is complete
+  if (isDrawing() && myFrameManager.getY() < FrameManager::frameBufferHeight)
+    markLineChanged(myFrameManager.getY());
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void TIA::updateChangedLines()
+{
+  const uInt32 height =
+    std::min(myFrameManager.height(), uInt32(FrameManager::frameBufferHeight));
+
+  memset(myCurrentChangedLines, 0, sizeof(myCurrentChangedLines));
+
+  // Without drawing, the frame buffer contents are not this frame's
+  if (!myDrawingEnabled) {
+    for (uInt32 y = 0; y < height; ++y) markLineChanged(y);
+    return;
+  }
+
+  const uInt8* current = myCurrentFrameBuffer.get();
+  const uInt8* previous = myPreviousFrameBuffer.get();
+
+  for (uInt32 y = 0; y < height; ++y)
+    if (memcmp(current + y * 160, previous + y * 160, 160) != 0)
+      markLineChanged(y);
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -1160,7 +1416,7 @@ void TIA::cloneLastLine()
 {
   const auto y = myFrameManager.getY();
 
-  if (!myFrameManager.isRendering() || y == 0) return;
+  if (!isDrawing() || y == 0) return;
 
   uInt8* buffer = myCurrentFrameBuffer.get();
 
@@ -1168,7 +1424,7 @@ void TIA::cloneLastLine()
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void TIA::updateCollision()
+void TIA::updateCollisionClock()
 {
   myCollisionMask |= (
     myPlayer0.collision &
@@ -1180,6 +1436,60 @@ void TIA::updateCollision()
   );
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+uInt32 TIA::collisionMask() const
+{
+  if (!myCollisionPending) return myCollisionMask;
+
+  // Same order as myObjectPixels
+  static constexpr uInt32 masks[6] = {
+    CollisionMask::playfield, CollisionMask::missile0, CollisionMask::missile1,
+    CollisionMask::player0, CollisionMask::player1, CollisionMask::ball
+  };
+  static constexpr uInt8 bits[6] = {
+    TIABit::PFBit, TIABit::M0Bit, TIABit::M1Bit,
+    TIABit::P0Bit, TIABit::P1Bit, TIABit::BLBit
+  };
+
+  uInt32 mask = myCollisionMask;
+
+  // Two objects collide if they have drawn any pixel in common
+  for (uInt32 a = 0; a < 5; a++) {
+    if (!(myCollisionsEnabledBits & bits[a])) continue;
+
+    for (uInt32 b = a + 1; b < 6; b++) {
+      const uInt32 collision = masks[a] & masks[b];
+
+      if ((mask & collision) || !(myCollisionsEnabledBits & bits[b]))
+        continue;
+
+      if ((myObjectPixels[a][0] & myObjectPixels[b][0]) |
+          (myObjectPixels[a][1] & myObjectPixels[b][1]) |
+          (myObjectPixels[a][2] & myObjectPixels[b][2]) |
+          (myObjectPixels[a][3] & myObjectPixels[b][3]))
+        mask |= collision;
+    }
+  }
+
+  return mask;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void TIA::updateCollision()
+{
+  if (!myCollisionPending) return;
+
+  myCollisionMask = collisionMask();
+  clearPixels();
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void TIA::clearPixels()
+{
+  memset(myObjectPixels, 0, sizeof(myObjectPixels));
+  myCollisionPending = false;
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void TIA::renderPixel(uInt32 x, uInt32 y)
 {
@@ -1254,7 +1564,7 @@ void TIA::flushLineCache()
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void TIA::clearHmoveComb()
 {
-  if (myFrameManager.isRendering() && myHstate == HState::blank)
+  if (isDrawing() && myHstate == HState::blank)
     memset(myCurrentFrameBuffer.get() + myFrameManager.getY() * 160,
            myColorHBlank, 8);
 }
@@ -1415,68 +1725,84 @@ uInt8 TIA::resxCounter()
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 uInt8 TIA::collCXM0P() const
 {
+  const uInt32 mask = collisionMask();
+
   return (
-    ((myCollisionMask & CollisionMask::missile0 & CollisionMask::player0) ? 0x40 : 0) |
-    ((myCollisionMask & CollisionMask::missile0 & CollisionMask::player1) ? 0x80 : 0)
+    ((mask & CollisionMask::missile0 & CollisionMask::player0) ? 0x40 : 0) |
+    ((mask & CollisionMask::missile0 & CollisionMask::player1) ? 0x80 : 0)
   );
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 uInt8 TIA::collCXM1P() const
 {
+  const uInt32 mask = collisionMask();
+
   return (
-    ((myCollisionMask & CollisionMask::missile1 & CollisionMask::player1) ? 0x40 : 0) |
-    ((myCollisionMask & CollisionMask::missile1 & CollisionMask::player0) ? 0x80 : 0)
+    ((mask & CollisionMask::missile1 & CollisionMask::player1) ? 0x40 : 0) |
+    ((mask & CollisionMask::missile1 & CollisionMask::player0) ? 0x80 : 0)
   );
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 uInt8 TIA::collCXP0FB() const
 {
+  const uInt32 mask = collisionMask();
+
   return (
-    ((myCollisionMask & CollisionMask::player0 & CollisionMask::ball) ? 0x40 : 0) |
-    ((myCollisionMask & CollisionMask::player0 & CollisionMask::playfield) ? 0x80 : 0)
+    ((mask & CollisionMask::player0 & CollisionMask::ball) ? 0x40 : 0) |
+    ((mask & CollisionMask::player0 & CollisionMask::playfield) ? 0x80 : 0)
   );
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 uInt8 TIA::collCXP1FB() const
 {
+  const uInt32 mask = collisionMask();
+
   return (
-    ((myCollisionMask & CollisionMask::player1 & CollisionMask::ball) ? 0x40 : 0) |
-    ((myCollisionMask & CollisionMask::player1 & CollisionMask::playfield) ? 0x80 : 0)
+    ((mask & CollisionMask::player1 & CollisionMask::ball) ? 0x40 : 0) |
+    ((mask & CollisionMask::player1 & CollisionMask::playfield) ? 0x80 : 0)
   );
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 uInt8 TIA::collCXM0FB() const
 {
+  const uInt32 mask = collisionMask();
+
   return (
-    ((myCollisionMask & CollisionMask::missile0 & CollisionMask::ball) ? 0x40 : 0) |
-    ((myCollisionMask & CollisionMask::missile0 & CollisionMask::playfield) ? 0x80 : 0)
+    ((mask & CollisionMask::missile0 & CollisionMask::ball) ? 0x40 : 0) |
+    ((mask & CollisionMask::missile0 & CollisionMask::playfield) ? 0x80 : 0)
   );
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 uInt8 TIA::collCXM1FB() const
 {
+  const uInt32 mask = collisionMask();
+
   return (
-    ((myCollisionMask & CollisionMask::missile1 & CollisionMask::ball) ? 0x40 : 0) |
-    ((myCollisionMask & CollisionMask::missile1 & CollisionMask::playfield) ? 0x80 : 0)
+    ((mask & CollisionMask::missile1 & CollisionMask::ball) ? 0x40 : 0) |
+    ((mask & CollisionMask::missile1 & CollisionMask::playfield) ? 0x80 : 0)
   );
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 uInt8 TIA::collCXPPMM() const
 {
+  const uInt32 mask = collisionMask();
+
   return (
-    ((myCollisionMask & CollisionMask::missile0 & CollisionMask::missile1) ? 0x40 : 0) |
-    ((myCollisionMask & CollisionMask::player0 & CollisionMask::player1) ? 0x80 : 0)
+    ((mask & CollisionMask::missile0 & CollisionMask::missile1) ? 0x40 : 0) |
+    ((mask & CollisionMask::player0 & CollisionMask::player1) ? 0x80 : 0)
   );
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 uInt8 TIA::collCXBLPF() const
 {
-  return (myCollisionMask & CollisionMask::ball & CollisionMask::playfield) ? 0x80 : 0;
+  const uInt32 mask = collisionMask();
+
+  return (mask & CollisionMask::ball & CollisionMask::playfield) ? 0x80 : 0;
 }
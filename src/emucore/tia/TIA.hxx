@@ -36,6 +36,8 @@
 #include "LatchedInput.hxx"
 #include "PaddleReader.hxx"
 
+class MovieRecorder;
+
 /**
   This class is a device that emulates the Television Interface Adaptor
   found in the Atari 2600 and 7800 consoles.  The Television Interface
@@ -160,6 +162,31 @@ class TIA : public Device
     uInt8* currentFrameBuffer() const  { return myCurrentFrameBuffer.get();  }
     uInt8* previousFrameBuffer() const { return myPreviousFrameBuffer.get(); }
 
+    /**
+      Answers whether the given line of the current/previous frame buffer
+      may differ from the same line of the frame drawn before it.  Lines
+      are compared when a frame completes, and the flags are swapped along
+      with the buffers.  Lines drawn since then are always reported as
+      changed, so this is valid for partially drawn frames as well.
+    */
+    bool lineChanged(uInt32 y) const {
+      return (myCurrentChangedLines[y >> 6] >> (y & 63)) & 1;
+    }
+    bool previousLineChanged(uInt32 y) const {
+      return (myPreviousChangedLines[y >> 6] >> (y & 63)) & 1;
+    }
+
+    /**
+      Answers whether any line of the current frame buffer differs from
+      the frame drawn before it; this detects identical frames.
+    */
+    bool frameChanged() const;
+
+    /**
+      Answers the number of frames completed since the last reset
+    */
+    uInt32 frameCount() const { return myFrameManager.frameCount(); }
+
     /**
       Answers dimensional info about the framebuffer
     */
@@ -193,6 +220,22 @@ class TIA : public Device
     */
     void enableAutoFrame(bool enabled) { myAutoFrameEnabled = enabled; }
 
+    /**
+      Enables/disables writing pixels to the frame buffers, which is used to
+      skip frames in turbo mode.  The TIA is otherwise emulated as usual.
+
+      @param enabled  Whether to enable or disable drawing
+    */
+    void enableDrawing(bool enabled) { myDrawingEnabled = enabled; }
+
+    /**
+      Sets the recorder to pass each completed frame and each write to the
+      audio registers to (see MovieRecorder).
+
+      @param recorder  The recorder, or nullptr to stop passing them
+    */
+    void setRecorder(MovieRecorder* recorder) { myRecorder = recorder; }
+
     /**
       Enables/disables color-loss for PAL modes only.
 
@@ -231,6 +274,14 @@ class TIA : public Device
     */
     uInt32 scanlinesLastFrame() const { return myFrameManager.scanlinesLastFrame(); }
 
+    /**
+      Answers the number of CPU cycles in the previous frame which were
+      skipped as part of RIOT timer polling loops (see M6502).
+
+      @return The number of cycles skipped in the last frame
+    */
+    uInt32 idleCyclesLastFrame() const { return myIdleCyclesLastFrame; }
+
     /**
       Answers whether the TIA is currently in being rendered
       (we're in between the start and end of drawing a frame).
@@ -398,6 +449,12 @@ class TIA : public Device
 
     void cycle(uInt32 colorClocks);
 
+    uInt32 skipIdleClocks(uInt32 maxClocks);
+
+    uInt32 tickHframeSpan(uInt32 maxClocks);
+
+    void renderSpan(Int32 x, uInt32 clocks);
+
     void tickMovement();
 
     void tickHblank();
@@ -406,8 +463,14 @@ class TIA : public Device
 
     void applyRsync();
 
+    void updateCollisionClock();
+
+    uInt32 collisionMask() const;
+
     void updateCollision();
 
+    void clearPixels();
+
     void renderPixel(uInt32 x, uInt32 y);
 
     void clearHmoveComb();
@@ -424,6 +487,16 @@ class TIA : public Device
 
     void swapBuffers();
 
+    void updateChangedLines();
+
+    void markLineChanged(uInt32 y) {
+      myCurrentChangedLines[y >> 6] |= uInt64(1) << (y & 63);
+    }
+
+    bool isDrawing() const {
+      return myDrawingEnabled && myFrameManager.isRendering();
+    }
+
     /**
       Get the result of the specified collision register.
     */
@@ -461,6 +534,13 @@ class TIA : public Device
     BytePtr myCurrentFrameBuffer;
     BytePtr myPreviousFrameBuffer;
 
+    // One bit per line of the current and previous frame buffers, set for
+    // lines which differ from the frame before (see lineChanged())
+    static constexpr uInt32 changedLineWords =
+      (FrameManager::frameBufferHeight + 63) / 64;
+    uInt64 myCurrentChangedLines[changedLineWords];
+    uInt64 myPreviousChangedLines[changedLineWords];
+
     bool myTIAPinsDriven;
 
     HState myHstate;
@@ -470,6 +550,14 @@ class TIA : public Device
     uInt32 myXDelta;
 
     bool myCollisionUpdateRequired;
+
+    // Collisions are evaluated lazily: the pixels drawn by each object on
+    // the current line (indexed by the horizontal counter) are collected,
+    // and only combined into the collision mask at the end of the line or
+    // when the collision registers are accessed; the objects are in the
+    // order PF, M0, M1, P0, P1, BL
+    uInt64 myObjectPixels[6][4];
+    bool myCollisionPending;
     uInt32 myCollisionMask;
 
     uInt32 myMovementClock;
@@ -483,18 +571,26 @@ class TIA : public Device
     uInt8 mySubClock;
     Int32 myLastCycle;
 
+    uInt32 myIdleCyclesLastFrame;
+
     uInt8 mySpriteEnabledBits;
     uInt8 myCollisionsEnabledBits;
 
     uInt8 myColorHBlank;
 
-    double myTimestamp;
+    uInt64 myTimestamp;
 
     uInt8 myShadowRegisters[64];
 
     // Automatic framerate correction based on number of scanlines
     bool myAutoFrameEnabled;
 
+    // Whether pixels are written to the frame buffers (see enableDrawing())
+    bool myDrawingEnabled;
+
+    // Frames and sound are passed to this recorder, if any
+    MovieRecorder* myRecorder;
+
     // Indicates if color loss should be enabled or disabled.  Color loss
     // occurs on PAL-like systems when the previous frame contains an odd
     // number of scanlines.
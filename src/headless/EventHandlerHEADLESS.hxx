@@ -0,0 +1,61 @@
+//============================================================================
+//
+//   SSSS    tt          lll  lll
+//  SS  SS   tt           ll   ll
+//  SS     tttttt  eeee   ll   ll   aaaa
+//   SSSS    tt   ee  ee  ll   ll      aa
+//      SS   tt   eeeeee  ll   ll   aaaaa  --  "An Atari 2600 VCS Emulator"
+//  SS  SS   tt   ee      ll   ll  aa  aa
+//   SSSS     ttt  eeeee llll llll  aaaaa
+//
+// Copyright (c) 1995-2017 by Bradford W. Mott, Stephen Anthony
+// and the Stella Team
+//
+// See the file "License.txt" for information on usage and redistribution of
+// this file, and for a DISCLAIMER OF ALL WARRANTIES.
+//============================================================================
+
+
+#ifndef EVENTHANDLER_HEADLESS_HXX
+#define EVENTHANDLER_HEADLESS_HXX
+
+#include "EventHandler.hxx"
+
+/**
+  This class handles event collection for the headless frontend.  Since
+  there's no window or input device, no events are ever generated; the
+  emulation simply runs with the controllers and console switches in
+  their default state.
+
+  @author  Stella Team
+*/
+class EventHandlerHEADLESS : public EventHandler
+{
+  public:
+    /**
+      Create a new headless event handler object
+    */
+    EventHandlerHEADLESS(OSystem& osystem) : EventHandler(osystem) { }
+    virtual ~EventHandlerHEADLESS() = default;
+
+  private:
+    /**
+      Enable/disable text events (distinct from single-key events).
+    */
+    void enableTextEvents(bool enable) override { }
+
+    /**
+      Collects and dispatches any pending events (there are none).
+    */
+    void pollEvent() override { }
+
+  private:
+    // Following constructors and assignment operators not supported
+    EventHandlerHEADLESS() = delete;
+    EventHandlerHEADLESS(const EventHandlerHEADLESS&) = delete;
+    EventHandlerHEADLESS(EventHandlerHEADLESS&&) = delete;
+    EventHandlerHEADLESS& operator=(const EventHandlerHEADLESS&) = delete;
+    EventHandlerHEADLESS& operator=(EventHandlerHEADLESS&&) = delete;
+};
+
+#endif
@@ -0,0 +1,73 @@
+//============================================================================
+//
+//   SSSS    tt          lll  lll
+//  SS  SS   tt           ll   ll
+//  SS     tttttt  eeee   ll   ll   aaaa
+//   SSSS    tt   ee  ee  ll   ll      aa
+//      SS   tt   eeeeee  ll   ll   aaaaa  --  "An Atari 2600 VCS Emulator"
+//  SS  SS   tt   ee      ll   ll  aa  aa
+//   SSSS     ttt  eeeee llll llll  aaaaa
+//
+// Copyright (c) 1995-2017 by Bradford W. Mott, Stephen Anthony
+// and the Stella Team
+//
+// See the file "License.txt" for information on usage and redistribution of
+// this file, and for a DISCLAIMER OF ALL WARRANTIES.
+//============================================================================
+
+
+#include "FBSurfaceHEADLESS.hxx"
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+FBSurfaceHEADLESS::FBSurfaceHEADLESS(uInt32 width, uInt32 height,
+                                     const uInt32* data)
+  : myWidth(0),
+    myHeight(0)
+{
+  createSurface(width, height, data);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void FBSurfaceHEADLESS::translateCoords(Int32& x, Int32& y) const
+{
+  x -= myDstR.x();
+  y -= myDstR.y();
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void FBSurfaceHEADLESS::invalidate()
+{
+  std::fill_n(myBuffer.get(), myWidth * myHeight, 0);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void FBSurfaceHEADLESS::resize(uInt32 width, uInt32 height)
+{
+  // We will only resize when necessary
+  if(width <= myWidth && height <= myHeight)
+    return;
+
+  createSurface(width, height, nullptr);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void FBSurfaceHEADLESS::createSurface(uInt32 width, uInt32 height,
+                                      const uInt32* data)
+{
+  myWidth = width;  myHeight = height;
+  myBuffer = make_ptr<uInt32[]>(width * height);
+  if(data)
+    std::copy_n(data, width * height, myBuffer.get());
+  else
+    std::fill_n(myBuffer.get(), width * height, 0);
+
+  // We start out with the src and dst rectangles containing the same
+  // dimensions, indicating no scaling or re-positioning
+  mySrcR = myDstR = GUI::Rect(width, height);
+
+  ////////////////////////////////////////////////////
+  // These *must* be set for the parent class
+  myPixels = myBuffer.get();
+  myPitch = width;
+  ////////////////////////////////////////////////////
+}
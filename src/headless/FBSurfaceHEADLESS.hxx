@@ -0,0 +1,78 @@
+//============================================================================
+//
+//   SSSS    tt          lll  lll
+//  SS  SS   tt           ll   ll
+//  SS     tttttt  eeee   ll   ll   aaaa
+//   SSSS    tt   ee  ee  ll   ll      aa
+//      SS   tt   eeeeee  ll   ll   aaaaa  --  "An Atari 2600 VCS Emulator"
+//  SS  SS   tt   ee      ll   ll  aa  aa
+//   SSSS     ttt  eeeee llll llll  aaaaa
+//
+// Copyright (c) 1995-2017 by Bradford W. Mott, Stephen Anthony
+// and the Stella Team
+//
+// See the file "License.txt" for information on usage and redistribution of
+// this file, and for a DISCLAIMER OF ALL WARRANTIES.
+//============================================================================
+
+
+#ifndef FBSURFACE_HEADLESS_HXX
+#define FBSURFACE_HEADLESS_HXX
+
+#include "bspf.hxx"
+#include "FBSurface.hxx"
+
+/**
+  An FBSurface which is never displayed.  The pixel data lives entirely in
+  system memory, so all the drawing primitives from FBSurface still work
+  (for example, for snapshots), but nothing is ever sent to a display.
+
+  @author  Stella Team
+*/
+class FBSurfaceHEADLESS : public FBSurface
+{
+  public:
+    FBSurfaceHEADLESS(uInt32 width, uInt32 height, const uInt32* data);
+    virtual ~FBSurfaceHEADLESS() = default;
+
+    uInt32 width() const override  { return myWidth;  }
+    uInt32 height() const override { return myHeight; }
+
+    const GUI::Rect& srcRect() const override { return mySrcR; }
+    const GUI::Rect& dstRect() const override { return myDstR; }
+    void setSrcPos(uInt32 x, uInt32 y) override  { mySrcR.moveTo(x, y); }
+    void setSrcSize(uInt32 w, uInt32 h) override
+      { mySrcR.setWidth(w);  mySrcR.setHeight(h); }
+    void setDstPos(uInt32 x, uInt32 y) override  { myDstR.moveTo(x, y); }
+    void setDstSize(uInt32 w, uInt32 h) override
+      { myDstR.setWidth(w);  myDstR.setHeight(h); }
+    void setVisible(bool visible) override { }
+
+    void translateCoords(Int32& x, Int32& y) const override;
+    bool render() override { return false; }
+    void invalidate() override;
+    void free() override { }
+    void reload() override { }
+    void resize(uInt32 width, uInt32 height) override;
+
+  protected:
+    void applyAttributes(bool immediate) override { }
+
+  private:
+    void createSurface(uInt32 width, uInt32 height, const uInt32* data);
+
+    // Following constructors and assignment operators not supported
+    FBSurfaceHEADLESS() = delete;
+    FBSurfaceHEADLESS(const FBSurfaceHEADLESS&) = delete;
+    FBSurfaceHEADLESS(FBSurfaceHEADLESS&&) = delete;
+    FBSurfaceHEADLESS& operator=(const FBSurfaceHEADLESS&) = delete;
+    FBSurfaceHEADLESS& operator=(FBSurfaceHEADLESS&&) = delete;
+
+  private:
+    unique_ptr<uInt32[]> myBuffer;
+    uInt32 myWidth, myHeight;
+
+    GUI::Rect mySrcR, myDstR;
+};
+
+#endif
@@ -0,0 +1,62 @@
+//============================================================================
+//
+//   SSSS    tt          lll  lll
+//  SS  SS   tt           ll   ll
+//  SS     tttttt  eeee   ll   ll   aaaa
+//   SSSS    tt   ee  ee  ll   ll      aa
+//      SS   tt   eeeeee  ll   ll   aaaaa  --  "An Atari 2600 VCS Emulator"
+//  SS  SS   tt   ee      ll   ll  aa  aa
+//   SSSS     ttt  eeeee llll llll  aaaaa
+//
+// Copyright (c) 1995-2017 by Bradford W. Mott, Stephen Anthony
+// and the Stella Team
+//
+// See the file "License.txt" for information on usage and redistribution of
+// this file, and for a DISCLAIMER OF ALL WARRANTIES.
+//============================================================================
+
+
+#include "bspf.hxx"
+
+#include "OSystem.hxx"
+#include "FBSurfaceHEADLESS.hxx"
+#include "FrameBufferHEADLESS.hxx"
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+FrameBufferHEADLESS::FrameBufferHEADLESS(OSystem& osystem)
+  : FrameBuffer(osystem)
+{
+  myOSystem.logMessage("FrameBufferHEADLESS::FrameBufferHEADLESS()", 2);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void FrameBufferHEADLESS::queryHardware(vector<GUI::Size>& displays,
+                                        VariantList& renderers)
+{
+  // Pretend there's a single display large enough for any mode we might
+  // want to create; nothing is ever shown on it anyway
+  displays.emplace_back(1920, 1080);
+
+  VarList::push_back(renderers, "None", "none");
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+string FrameBufferHEADLESS::about() const
+{
+  return "Video system: headless\n";
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+unique_ptr<FBSurface> FrameBufferHEADLESS::createSurface(uInt32 w, uInt32 h,
+                                              const uInt32* data) const
+{
+  return make_ptr<FBSurfaceHEADLESS>(w, h, data);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void FrameBufferHEADLESS::readPixels(uInt8* pixels, uInt32 pitch,
+                                     const GUI::Rect& rect) const
+{
+  for(uInt32 y = 0; y < rect.height(); ++y)
+    std::fill_n(pixels + y * pitch, rect.width() * 4, 0);
+}
@@ -0,0 +1,166 @@
+//============================================================================
+//
+//   SSSS    tt          lll  lll
+//  SS  SS   tt           ll   ll
+//  SS     tttttt  eeee   ll   ll   aaaa
+//   SSSS    tt   ee  ee  ll   ll      aa
+//      SS   tt   eeeeee  ll   ll   aaaaa  --  "An Atari 2600 VCS Emulator"
+//  SS  SS   tt   ee      ll   ll  aa  aa
+//   SSSS     ttt  eeeee llll llll  aaaaa
+//
+// Copyright (c) 1995-2017 by Bradford W. Mott, Stephen Anthony
+// and the Stella Team
+//
+// See the file "License.txt" for information on usage and redistribution of
+// this file, and for a DISCLAIMER OF ALL WARRANTIES.
+//============================================================================
+
+
+#ifndef FRAMEBUFFER_HEADLESS_HXX
+#define FRAMEBUFFER_HEADLESS_HXX
+
+class OSystem;
+
+#include "bspf.hxx"
+#include "FrameBuffer.hxx"
+
+/**
+  This class implements a framebuffer which never opens a window.  It
+  reports a single fixed-size display and keeps all surfaces in system
+  memory, so that the emulation core and GUI can run completely unchanged
+  without any video hardware (or SDL) present.
+
+  @author  Stella Team
+*/
+class FrameBufferHEADLESS : public FrameBuffer
+{
+  public:
+    /**
+      Creates a new headless framebuffer
+    */
+    FrameBufferHEADLESS(OSystem& osystem);
+    virtual ~FrameBufferHEADLESS() = default;
+
+    //////////////////////////////////////////////////////////////////////
+    // The following are derived from public methods in FrameBuffer.hxx
+    //////////////////////////////////////////////////////////////////////
+    /**
+      Shows or hides the cursor based on the given boolean value.
+    */
+    void showCursor(bool show) override { }
+
+    /**
+      Answers if the display is currently in fullscreen mode.
+    */
+    bool fullScreen() const override { return false; }
+
+    /**
+      This method is called to retrieve the R/G/B data from the given pixel.
+
+      @param pixel  The pixel containing R/G/B data
+      @param r      The red component of the color
+      @param g      The green component of the color
+      @param b      The blue component of the color
+    */
+    inline void getRGB(Uint32 pixel, Uint8* r, Uint8* g, Uint8* b) const override
+      { *r = (pixel >> 16) & 0xff;  *g = (pixel >> 8) & 0xff;  *b = pixel & 0xff; }
+
+    /**
+      This method is called to map a given R/G/B triple to the screen palette.
+      Pixels are always stored in ARGB8888 format.
+
+      @param r  The red component of the color.
+      @param g  The green component of the color.
+      @param b  The blue component of the color.
+    */
+    inline Uint32 mapRGB(Uint8 r, Uint8 g, Uint8 b) const override
+      { return 0xff000000 | (r << 16) | (g << 8) | b; }
+
+    /**
+      This method is called to get a copy of the specified ARGB data from the
+      viewable FrameBuffer area.  Since nothing is ever displayed, the
+      buffer is simply cleared.
+
+      @param buffer  A copy of the pixel data in ARGB8888 format
+      @param pitch   The pitch (in bytes) for the pixel data
+      @param rect    The bounding rectangle for the buffer
+    */
+    void readPixels(uInt8* buffer, uInt32 pitch, const GUI::Rect& rect) const override;
+
+  protected:
+    //////////////////////////////////////////////////////////////////////
+    // The following are derived from protected methods in FrameBuffer.hxx
+    //////////////////////////////////////////////////////////////////////
+    /**
+      This method is called to query and initialize the video hardware
+      for desktop and fullscreen resolution information.
+    */
+    void queryHardware(vector<GUI::Size>& displays, VariantList& renderers) override;
+
+    /**
+      This method is called to query the video hardware for the index
+      of the display the current window is displayed on
+
+      @return  the current display index or a negative value if no
+               window is displayed
+    */
+    Int32 getCurrentDisplayIndex() override { return 0; }
+
+    /**
+      This method is called to change to the given video mode.
+
+      @param title The title for the created window
+      @param mode  The video mode to use
+
+      @return  False on any errors, else true
+    */
+    bool setVideoMode(const string& title, const VideoMode& mode) override
+      { return true; }
+
+    /**
+      This method is called to invalidate the contents of the entire
+      framebuffer (ie, mark the current content as invalid, and erase it on
+      the next drawing pass).
+    */
+    void invalidate() override { }
+
+    /**
+      This method is called to create a surface with the given attributes.
+
+      @param w     The requested width of the new surface.
+      @param h     The requested height of the new surface.
+      @param data  If non-null, use the given data values as a static surface
+    */
+    unique_ptr<FBSurface> createSurface(uInt32 w, uInt32 h, const uInt32* data)
+        const override;
+
+    /**
+      Grabs or ungrabs the mouse based on the given boolean value.
+    */
+    void grabMouse(bool grab) override { }
+
+    /**
+      Set the icon for the main window.
+    */
+    void setWindowIcon() override { }
+
+    /**
+      This method is called to provide information about the FrameBuffer.
+    */
+    string about() const override;
+
+    /**
+      This method is called after any drawing is done (per-frame).
+    */
+    void postFrameUpdate() override { }
+
+  private:
+    // Following constructors and assignment operators not supported
+    FrameBufferHEADLESS() = delete;
+    FrameBufferHEADLESS(const FrameBufferHEADLESS&) = delete;
+    FrameBufferHEADLESS(FrameBufferHEADLESS&&) = delete;
+    FrameBufferHEADLESS& operator=(const FrameBufferHEADLESS&) = delete;
+    FrameBufferHEADLESS& operator=(FrameBufferHEADLESS&&) = delete;
+};
+
+#endif
@@ -0,0 +1,250 @@
+//============================================================================
+//
+//   SSSS    tt          lll  lll
+//  SS  SS   tt           ll   ll
+//  SS     tttttt  eeee   ll   ll   aaaa
+//   SSSS    tt   ee  ee  ll   ll      aa
+//      SS   tt   eeeeee  ll   ll   aaaaa  --  "An Atari 2600 VCS Emulator"
+//  SS  SS   tt   ee      ll   ll  aa  aa
+//   SSSS     ttt  eeeee llll llll  aaaaa
+//
+// Copyright (c) 1995-2017 by Bradford W. Mott, Stephen Anthony
+// and the Stella Team
+//
+// See the file "License.txt" for information on usage and redistribution of
+// this file, and for a DISCLAIMER OF ALL WARRANTIES.
+//============================================================================
+
+
+#include <cstdlib>
+#include <fstream>
+
+#include "Console.hxx"
+#include "EventHandler.hxx"
+#include "FrameBuffer.hxx"
+#include "M6532.hxx"
+#include "MovieRecorder.hxx"
+#include "Settings.hxx"
+#include "TIA.hxx"
+#include "TIASurface.hxx"
+
+#include "OSystemHEADLESS.hxx"
+
+/**
+  Each derived class is responsible for calling the following methods
+  in its constructor:
+
+  setBaseDir()
+  setConfigFile()
+
+  See OSystem.hxx for a further explanation
+*/
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+OSystemHEADLESS::OSystemHEADLESS()
+  : OSystem()
+{
+  // Use XDG_CONFIG_HOME if defined, otherwise use the default
+  const char* configDir = getenv("XDG_CONFIG_HOME");
+  if(configDir == NULL)  configDir = "~/.config";
+
+  string stellaDir = string(configDir) + "/stella";
+
+  // The headless build uses its own config file, so that automated runs
+  // can't change the settings of the regular application
+  setBaseDir(stellaDir);
+  setConfigFile(stellaDir + "/stellarc-headless");
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void OSystemHEADLESS::mainLoop()
+{
+  if(!myConsole)
+  {
+    logMessage("ERROR: A ROM must be specified in headless mode", 0);
+    return;
+  }
+
+  const Int32 frames = mySettings->getInt("hl.frames");
+  const string& videoFile = mySettings->getString("hl.video");
+  const string& ramFile = mySettings->getString("hl.ram");
+
+  std::ofstream video, ram;
+  if(videoFile != "")
+  {
+    video.open(videoFile, std::ios::out | std::ios::binary | std::ios::trunc);
+    if(!video.is_open())
+      logMessage("ERROR: Couldn't open video dump " + videoFile, 0);
+  }
+  if(ramFile != "")
+  {
+    ram.open(ramFile, std::ios::out | std::ios::binary | std::ios::trunc);
+    if(!ram.is_open())
+      logMessage("ERROR: Couldn't open RAM dump " + ramFile, 0);
+  }
+
+  const string& recordFile = mySettings->getString("hl.record");
+  if(recordFile != "")
+  {
+    try
+    {
+      myMovieRecorder->start(recordFile);
+    }
+    catch(const runtime_error& e)
+    {
+      logMessage(e.what(), 0);
+    }
+  }
+
+  TIA& tia = myConsole->tia();
+  const M6532& riot = myConsole->riot();
+
+  const uInt64 startTime = getTicks();
+  uInt64 idleCycles = 0;
+  Int32 frame;
+  for(frame = 0; frame < frames; ++frame)
+  {
+    myEventHandler->poll(getTicks());
+    if(myQuitLoop) break;
+
+    tia.update();
+    idleCycles += tia.idleCyclesLastFrame();
+
+    // Each frame is written as a separate binary PGM image, containing the
+    // raw palette indices generated by the TIA; the resulting file is
+    // a valid (multi-image) netpbm stream
+    if(video.is_open())
+    {
+      video << "P5\n" << tia.width() << " " << tia.height() << "\n255\n";
+      video.write(reinterpret_cast<const char*>(tia.currentFrameBuffer()),
+                  tia.width() * tia.height());
+    }
+    if(ram.is_open())
+      ram.write(reinterpret_cast<const char*>(riot.getRAM()), 128);
+  }
+  const uInt64 elapsed = getTicks() - startTime;
+
+  ostringstream buf;
+  buf << "Emulated " << frame << " frames in " << (elapsed / 1000) << " ms";
+  if(elapsed > 0)
+    buf << " (" << std::fixed << std::setprecision(2)
+        << (frame * 1000000.0 / elapsed) << " fps)";
+  if(frame > 0)
+    buf << ", " << (idleCycles / frame) << " idle cycles/frame skipped";
+  logMessage(buf.str(), 0);
+
+  if(myMovieRecorder->isRecording())
+    logMessage(myMovieRecorder->stop(), 0);
+  if(myMovieRecorder->isStreaming())
+    logMessage(myMovieRecorder->stopStream(), 0);
+
+  const Int32 ntscRuns = mySettings->getInt("hl.ntscbench");
+  if(ntscRuns > 0 && frame > 0)
+    benchmarkNTSC(ntscRuns);
+
+  const Int32 convRuns = mySettings->getInt("hl.convbench");
+  if(convRuns > 0 && frame > 0)
+    benchmarkConversion(convRuns);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void OSystemHEADLESS::benchmarkNTSC(Int32 runs)
+{
+  static const NTSCFilter::Preset presets[] = {
+    NTSCFilter::PRESET_COMPOSITE, NTSCFilter::PRESET_SVIDEO,
+    NTSCFilter::PRESET_RGB, NTSCFilter::PRESET_BAD, NTSCFilter::PRESET_CUSTOM
+  };
+
+  const TIA& tia = myConsole->tia();
+  const uInt32 width = tia.width(), height = tia.height();
+  const uInt32 outWidth = ATARI_NTSC_OUT_WIDTH(width);
+  vector<uInt32> scalar(outWidth * height), simd(outWidth * height);
+
+  // Only compare the filter itself, not the threading
+  NTSCFilter& ntsc = myFrameBuffer->tiaSurface().ntsc();
+  ntsc.loadConfig(*mySettings);
+  ntsc.setThreads(1);
+
+  for(auto preset: presets)
+  {
+    const string& name = ntsc.setPreset(preset);
+    uInt64 ticks[2];
+    for(int i = 0; i < 2; ++i)
+    {
+      uInt32* out = i == 0 ? scalar.data() : simd.data();
+      ntsc.enableSIMD(i == 1);
+
+      const uInt64 start = getTicks();
+      for(Int32 run = 0; run < runs; ++run)
+        ntsc.blit_single(tia.currentFrameBuffer(), width, height,
+                         out, outWidth << 2);
+      ticks[i] = getTicks() - start;
+    }
+    ntsc.enableSIMD(true);
+
+    ostringstream buf;
+    buf << "NTSC filter " << name << ": " << std::fixed << std::setprecision(1)
+        << (double(ticks[0]) / runs) << " us/frame portable, "
+        << (double(ticks[1]) / runs) << " us/frame SIMD"
+        << (scalar == simd ? "" : " (OUTPUT DIFFERS)");
+    logMessage(buf.str(), 0);
+  }
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void OSystemHEADLESS::benchmarkConversion(Int32 runs)
+{
+  const TIA& tia = myConsole->tia();
+  const uInt32 size = tia.width() * tia.height();
+  vector<uInt32> image(size), shown(size), start(size);
+  vector<uInt32> result[2];
+  uInt64 ticks[2];
+
+  TIASurface& surface = myFrameBuffer->tiaSurface();
+
+  // Normal mode: only the palette expansion
+  for(int i = 0; i < 2; ++i)
+  {
+    surface.enableSIMD(i == 1);
+
+    const uInt64 begin = getTicks();
+    for(Int32 run = 0; run < runs; ++run)
+      surface.convertFrame(image.data());
+    ticks[i] = getTicks() - begin;
+    result[i] = image;
+  }
+
+  ostringstream buf;
+  buf << "Normal conversion: " << std::fixed << std::setprecision(1)
+      << (double(ticks[0]) / runs) << " us/frame portable, "
+      << (double(ticks[1]) / runs) << " us/frame SIMD"
+      << (result[0] == result[1] ? "" : " (OUTPUT DIFFERS)");
+  logMessage(buf.str(), 0);
+
+  // Phosphor mode: every run starts from the same image shown before, the
+  // frame faded in over black once, so that most pixels are actually blended
+  surface.convertFrame(image.data(), start.data());
+
+  for(int i = 0; i < 2; ++i)
+  {
+    surface.enableSIMD(i == 1);
+
+    ticks[i] = 0;
+    for(Int32 run = 0; run < runs; ++run)
+    {
+      shown = start;
+      const uInt64 begin = getTicks();
+      surface.convertFrame(image.data(), shown.data());
+      ticks[i] += getTicks() - begin;
+    }
+    result[i] = shown;
+  }
+  surface.enableSIMD(true);
+
+  buf.str("");
+  buf << "Phosphor conversion: " << std::fixed << std::setprecision(1)
+      << (double(ticks[0]) / runs) << " us/frame portable, "
+      << (double(ticks[1]) / runs) << " us/frame SIMD"
+      << (result[0] == result[1] ? "" : " (OUTPUT DIFFERS)");
+  logMessage(buf.str(), 0);
+}
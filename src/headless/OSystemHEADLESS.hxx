@@ -0,0 +1,72 @@
+//============================================================================
+//
+//   SSSS    tt          lll  lll
+//  SS  SS   tt           ll   ll
+//  SS     tttttt  eeee   ll   ll   aaaa
+//   SSSS    tt   ee  ee  ll   ll      aa
+//      SS   tt   eeeeee  ll   ll   aaaaa  --  "An Atari 2600 VCS Emulator"
+//  SS  SS   tt   ee      ll   ll  aa  aa
+//   SSSS     ttt  eeeee llll llll  aaaaa
+//
+// Copyright (c) 1995-2017 by Bradford W. Mott, Stephen Anthony
+// and the Stella Team
+//
+// See the file "License.txt" for information on usage and redistribution of
+// this file, and for a DISCLAIMER OF ALL WARRANTIES.
+//============================================================================
+
+
+#ifndef OSYSTEM_HEADLESS_HXX
+#define OSYSTEM_HEADLESS_HXX
+
+#include "OSystem.hxx"
+
+/**
+  This class defines the OSystem for the headless (SDL-free) frontend.
+  Rather than presenting frames in real-time, the main loop emulates a
+  fixed number of frames as fast as possible, optionally dumping the
+  raw frame buffers and RIOT RAM after each frame.  This makes it
+  suitable for automated regression testing and benchmarking of the
+  emulation core.
+
+  @author  Stella Team
+*/
+class OSystemHEADLESS : public OSystem
+{
+  public:
+    /**
+      Create a new headless operating system object
+    */
+    OSystemHEADLESS();
+    virtual ~OSystemHEADLESS() = default;
+
+    /**
+      Runs the emulation for the number of frames specified by 'hl.frames',
+      without any frame pacing or presentation.
+    */
+    void mainLoop() override;
+
+  private:
+    /**
+      Filters the current frame 'runs' times with each of the TV effects
+      presets, using both the SIMD and the portable version of the filter,
+      and logs the time taken per frame and whether the results match.
+    */
+    void benchmarkNTSC(Int32 runs);
+
+    /**
+      Converts the current frame 'runs' times as normal and as phosphor
+      mode do, using both the SIMD and the portable kernels, and logs the
+      time taken per frame and whether the results match.
+    */
+    void benchmarkConversion(Int32 runs);
+
+  private:
+    // Following constructors and assignment operators not supported
+    OSystemHEADLESS(const OSystemHEADLESS&) = delete;
+    OSystemHEADLESS(OSystemHEADLESS&&) = delete;
+    OSystemHEADLESS& operator=(const OSystemHEADLESS&) = delete;
+    OSystemHEADLESS& operator=(OSystemHEADLESS&&) = delete;
+};
+
+#endif
@@ -0,0 +1,118 @@
+//============================================================================
+//
+//   SSSS    tt          lll  lll
+//  SS  SS   tt           ll   ll
+//  SS     tttttt  eeee   ll   ll   aaaa
+//   SSSS    tt   ee  ee  ll   ll      aa
+//      SS   tt   eeeeee  ll   ll   aaaaa  --  "An Atari 2600 VCS Emulator"
+//  SS  SS   tt   ee      ll   ll  aa  aa
+//   SSSS     ttt  eeeee llll llll  aaaaa
+//
+// Copyright (c) 1995-2017 by Bradford W. Mott, Stephen Anthony
+// and the Stella Team
+//
+// See the file "License.txt" for information on usage and redistribution of
+// this file, and for a DISCLAIMER OF ALL WARRANTIES.
+//============================================================================
+
+
+#include "Base.hxx"
+#include "OSystem.hxx"
+#include "Settings.hxx"
+#include "Serializer.hxx"
+#include "TIATypes.hxx"
+
+#include "SoundHEADLESS.hxx"
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+SoundHEADLESS::SoundHEADLESS(OSystem& osystem)
+  : Sound(osystem),
+    myLastRegisterSetCycle(0),
+    myCycleBase(0)
+{
+  memset(myRegisters, 0, sizeof(myRegisters));
+  myOSystem.logMessage("SoundHEADLESS::SoundHEADLESS()", 2);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void SoundHEADLESS::open()
+{
+  const string& file = myOSystem.settings().getString("hl.audio");
+  if(file == "" || myLog.is_open())
+    return;
+
+  myLog.open(file, std::ios::out | std::ios::trunc);
+  if(!myLog.is_open())
+    myOSystem.logMessage("ERROR: Couldn't open audio log " + file, 0);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void SoundHEADLESS::close()
+{
+  if(myLog.is_open())
+    myLog.close();
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void SoundHEADLESS::reset()
+{
+  memset(myRegisters, 0, sizeof(myRegisters));
+  myLastRegisterSetCycle = 0;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void SoundHEADLESS::set(uInt16 addr, uInt8 value, Int32 cycle)
+{
+  if(addr < AUDC0 || addr > AUDV1)
+    return;
+
+  myRegisters[addr - AUDC0] = value;
+  myLastRegisterSetCycle = cycle;
+
+  if(myLog.is_open())
+    myLog << std::dec << (myCycleBase + cycle) << " " << Common::Base::HEX2 << addr
+          << " " << Common::Base::HEX2 << int(value) << "\n";
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool SoundHEADLESS::save(Serializer& out) const
+{
+  try
+  {
+    out.putString(name());
+
+    for(int i = 0; i < 6; ++i)
+      out.putByte(myRegisters[i]);
+
+    out.putInt(myLastRegisterSetCycle);
+  }
+  catch(...)
+  {
+    myOSystem.logMessage("ERROR: SoundHEADLESS::save", 0);
+    return false;
+  }
+
+  return true;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool SoundHEADLESS::load(Serializer& in)
+{
+  try
+  {
+    if(in.getString() != name())
+      return false;
+
+    for(int i = 0; i < 6; ++i)
+      myRegisters[i] = in.getByte();
+
+    myLastRegisterSetCycle = in.getInt();
+  }
+  catch(...)
+  {
+    myOSystem.logMessage("ERROR: SoundHEADLESS::load", 0);
+    return false;
+  }
+
+  return true;
+}
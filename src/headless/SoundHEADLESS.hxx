@@ -0,0 +1,181 @@
+//============================================================================
+//
+//   SSSS    tt          lll  lll
+//  SS  SS   tt           ll   ll
+//  SS     tttttt  eeee   ll   ll   aaaa
+//   SSSS    tt   ee  ee  ll   ll      aa
+//      SS   tt   eeeeee  ll   ll   aaaaa  --  "An Atari 2600 VCS Emulator"
+//  SS  SS   tt   ee      ll   ll  aa  aa
+//   SSSS     ttt  eeeee llll llll  aaaaa
+//
+// Copyright (c) 1995-2017 by Bradford W. Mott, Stephen Anthony
+// and the Stella Team
+//
+// See the file "License.txt" for information on usage and redistribution of
+// this file, and for a DISCLAIMER OF ALL WARRANTIES.
+//============================================================================
+
+
+#ifndef SOUND_HEADLESS_HXX
+#define SOUND_HEADLESS_HXX
+
+class OSystem;
+
+#include <fstream>
+
+#include "bspf.hxx"
+#include "Sound.hxx"
+
+/**
+  This class implements a sound object which produces no output, but
+  optionally logs every write to the TIA audio registers to a file, for
+  use in regression testing of the emulation core.
+
+  Each write is recorded on a separate line as '<cycle> <register> <value>',
+  where 'cycle' is the absolute number of system cycles since the sound
+  object was created (it does not wrap at the end of each frame).
+
+  @author Stella Team
+*/
+class SoundHEADLESS : public Sound
+{
+  public:
+    /**
+      Create a new sound object.  The init method must be invoked before
+      using the object.
+    */
+    SoundHEADLESS(OSystem& osystem);
+    virtual ~SoundHEADLESS() = default;
+
+  public:
+    /**
+      Enables/disables the sound subsystem.
+
+      @param enable  Either true or false, to enable or disable the sound system
+    */
+    void setEnabled(bool enable) override { }
+
+    /**
+      The system cycle counter is being adjusting by the specified amount.  Any
+      members using the system cycle counter should be adjusted as needed.
+
+      @param amount The amount the cycle counter is being adjusted by
+    */
+    void adjustCycleCounter(Int32 amount) override { myCycleBase -= amount; }
+
+    /**
+      Sets the number of channels (mono or stereo sound).
+
+      @param channels The number of channels
+    */
+    void setChannels(uInt32 channels) override { }
+
+    /**
+      Sets the display framerate.  Sound generation for NTSC and PAL games
+      depends on the framerate, so we need to set it here.
+
+      @param framerate The base framerate depending on NTSC or PAL ROM
+    */
+    void setFrameRate(float framerate) override { }
+
+    /**
+      Opens the register log file (if one was specified).
+    */
+    void open() override;
+
+    /**
+      Closes the register log file.
+    */
+    void close() override;
+
+    /**
+      Set the mute state of the sound object.  While muted no sound is played.
+
+      @param state Mutes sound if true, unmute if false
+    */
+    void mute(bool state) override { }
+
+    /**
+      Reset the sound device.
+    */
+    void reset() override;
+
+    /**
+      Sets the sound register to a given value, and logs the write.
+
+      @param addr  The register address
+      @param value The value to save into the register
+      @param cycle The system cycle at which the register is being updated
+    */
+    void set(uInt16 addr, uInt8 value, Int32 cycle) override;
+
+    /**
+      Sets the volume of the sound device to the specified level.  The
+      volume is given as a percentage from 0 to 100.  Values outside
+      this range indicate that the volume shouldn't be changed at all.
+
+      @param percent The new volume percentage level for the sound device
+    */
+    void setVolume(Int32 percent) override { }
+
+    /**
+      Adjusts the volume of the sound device based on the given direction.
+
+      @param direction  Increase or decrease the current volume by a predefined
+                        amount based on the direction (1 = increase, -1 =decrease)
+    */
+    void adjustVolume(Int8 direction) override { }
+
+    // Nothing is played, so there is no latency
+    uInt32 latency() const override { return 0; }
+
+    // The sample rate is never adjusted
+    double rateAdjust() const override { return 0.0; }
+
+  public:
+    /**
+      Saves the current state of this device to the given Serializer.
+
+      @param out The serializer device to save to.
+      @return The result of the save.  True on success, false on failure.
+    */
+    bool save(Serializer& out) const override;
+
+    /**
+      Loads the current state of this device from the given Serializer.
+
+      @param in The Serializer device to load from.
+      @return The result of the load.  True on success, false on failure.
+    */
+    bool load(Serializer& in) override;
+
+    /**
+      Get a descriptor for this console class (used in error checking).
+
+      @return The name of the object
+    */
+    string name() const override { return "TIASound"; }
+
+  private:
+    // The current contents of the six TIA audio registers (AUDC0 .. AUDV1)
+    uInt8 myRegisters[6];
+
+    // Cycle of the last register write (relative to the current frame)
+    Int32 myLastRegisterSetCycle;
+
+    // Accumulated system cycles from previous frames
+    uInt64 myCycleBase;
+
+    // Register writes are logged here (when open)
+    std::ofstream myLog;
+
+  private:
+    // Following constructors and assignment operators not supported
+    SoundHEADLESS() = delete;
+    SoundHEADLESS(const SoundHEADLESS&) = delete;
+    SoundHEADLESS(SoundHEADLESS&&) = delete;
+    SoundHEADLESS& operator=(const SoundHEADLESS&) = delete;
+    SoundHEADLESS& operator=(SoundHEADLESS&&) = delete;
+};
+
+#endif
@@ -0,0 +1,13 @@
+MODULE := src/headless
+
+MODULE_OBJS := \
+	src/headless/FBSurfaceHEADLESS.o \
+	src/headless/FrameBufferHEADLESS.o \
+	src/headless/OSystemHEADLESS.o \
+	src/headless/SoundHEADLESS.o
+
+MODULE_DIRS += \
+	src/headless
+
+# Include common rules 
+include $(srcdir)/common.rules